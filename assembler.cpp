@@ -5,9 +5,123 @@
 #include <sstream>
 #include <fstream>
 #include <algorithm> 
-#include <regex>
+#include <cstring>
+#include <functional>
+#include <thread>
 
 #include "isa.h"
+#include "host_timer.h"
+#include "program_image.h"
+#include "scheduler.h"
+
+namespace {
+    /*
+        lexer character classes
+     */
+    bool is_word(char ch) {
+        return std::isalnum(static_cast<unsigned char>(ch)) || '_' == ch;
+    }
+    bool is_separator(char ch, const char *separator) {
+        return std::isspace(static_cast<unsigned char>(ch)) || ('\0' != ch && nullptr != std::strchr(separator, ch));
+    }
+
+    char lower(char ch) {
+        return ('A' <= ch && ch <= 'Z') ? ch - 'A' + 'a' : ch;
+    }
+
+    /**
+        Copy slice in lower case -- the parser is case-insensitive, only kept & reported text is lowered.
+
+        @param text input slice.
+    */
+    std::string to_lower(std::string_view text) {
+        std::string result(text.size(), ' ');
+        std::transform(text.begin(), text.end(), result.begin(), lower);
+        return result;
+    }
+
+    /*
+        register names packed into 32-bit keys, sorted for binary search
+     */
+    const std::size_t MAX_REGISTER_NAME = 4;
+
+    std::uint32_t pack_register_name(const char *name, std::size_t length) {
+        std::uint32_t key = 0;
+        for (std::size_t i = 0; i < length; ++i) {
+            key = (key << 8) | static_cast<unsigned char>(lower(name[i]));
+        }
+        return key;
+    }
+
+    std::vector<std::pair<std::uint32_t, std::uint8_t>> build_register_keys(void) {
+        std::vector<std::pair<std::uint32_t, std::uint8_t>> keys;
+        for (const auto &entry: ISA::REGISTER_FILE) {
+            keys.push_back({pack_register_name(entry.first.data(), entry.first.size()), entry.second});
+        }
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+    const std::vector<std::pair<std::uint32_t, std::uint8_t>> REGISTER_KEYS = build_register_keys();
+
+    /*
+        smallest chunk worth a worker thread, in lines
+     */
+    const std::size_t MIN_CHUNK_SIZE = 4096;
+
+    /**
+        Split [0, count) into contiguous chunks and process them on up to jobs threads, inline for a single chunk.
+
+        @param count number of items.
+        @param jobs maximum number of chunks.
+        @param function chunk handler, called with chunk index, begin & end.
+    */
+    void for_each_chunk(
+        std::size_t count, std::size_t jobs,
+        const std::function<void(std::size_t, std::size_t, std::size_t)> &function
+    ) {
+        const std::size_t NUM_CHUNKS = std::max(
+            std::size_t(1), std::min(jobs, (count + MIN_CHUNK_SIZE - 1) / MIN_CHUNK_SIZE)
+        );
+        const std::size_t CHUNK_SIZE = (count + NUM_CHUNKS - 1) / NUM_CHUNKS;
+
+        if (1 == NUM_CHUNKS) {
+            function(0, 0, count);
+            return;
+        }
+
+        std::vector<std::thread> workers;
+        for (std::size_t chunk = 0; chunk < NUM_CHUNKS; ++chunk) {
+            const std::size_t begin = std::min(count, chunk * CHUNK_SIZE);
+            const std::size_t end = std::min(count, begin + CHUNK_SIZE);
+
+            workers.emplace_back(function, chunk, begin, end);
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    }
+
+    /**
+        Look up register address by name.
+
+        @param name register name, without '$', in any case.
+        @param length name length.
+        @return register address, -1 for unknown register.
+    */
+    int find_register(const char *name, std::size_t length) {
+        if (0 == length || MAX_REGISTER_NAME < length) {
+            return -1;
+        }
+
+        const std::uint32_t key = pack_register_name(name, length);
+        auto result = std::lower_bound(
+            REGISTER_KEYS.begin(), REGISTER_KEYS.end(), std::make_pair(key, std::uint8_t(0))
+        );
+
+        return (REGISTER_KEYS.end() != result && key == result->first) ? result->second : -1;
+    }
+}
 
 /*
     opcode + funct
@@ -42,74 +156,74 @@ const std::map<std::string, Assembler::ITypeField> Assembler::I_TYPE_FIELD = {
         J-Type: opcode[31-26] address[25-00]
 */
 // 1. Decoders for R-type instructions:
+// op $rd $rs $rt
 const Assembler::Decoder Assembler::R_TYPE_Decoder_1 = {
     ISA::Type::R_TYPE, 
-    "^(\\w+)\\s+\\$(\\w+)[\\s|,]+\\$(\\w+)[\\s|,]+\\$(\\w+)$",
     {
-        {1, ISA::Field::OPCODE},
-        {2, ISA::Field::RD},
-        {3, ISA::Field::RS},
-        {4, ISA::Field::RT}
-    }
+        {ISA::Field::RD, Assembler::Operand::REGISTER, ""},
+        {ISA::Field::RS, Assembler::Operand::REGISTER, "|,"},
+        {ISA::Field::RT, Assembler::Operand::REGISTER, "|,"}
+    },
+    ""
 };
+// op $rs $rt
 const Assembler::Decoder Assembler::R_TYPE_Decoder_2 = {
     ISA::Type::R_TYPE, 
-    "^(\\w+)\\s+\\$(\\w+)[\\s|,]+\\$(\\w+)$",
     {
-        {1, ISA::Field::OPCODE},
-        {2, ISA::Field::RS},
-        {3, ISA::Field::RT}
-    }
+        {ISA::Field::RS, Assembler::Operand::REGISTER, ""},
+        {ISA::Field::RT, Assembler::Operand::REGISTER, "|,"}
+    },
+    ""
 };
+// op $rd $rt shamt
 const Assembler::Decoder Assembler::R_TYPE_Decoder_3 = {
     ISA::Type::R_TYPE, 
-    "^(\\w+)\\s+\\$(\\w+)[\\s|,]+\\$(\\w+)[\\s|,]+(\\w+)$",
     {
-        {1, ISA::Field::OPCODE},
-        {2, ISA::Field::RD},
-        {3, ISA::Field::RT},
-        {4, ISA::Field::SHAMT}
-    }
+        {ISA::Field::RD, Assembler::Operand::REGISTER, ""},
+        {ISA::Field::RT, Assembler::Operand::REGISTER, "|,"},
+        {ISA::Field::SHAMT, Assembler::Operand::IMMEDIATE, "|,"}
+    },
+    ""
 };
 // 2. Decoders for I-type instructions:
+// op $rt $rs imm
 const Assembler::Decoder Assembler::I_TYPE_Decoder_1 = {
     ISA::Type::I_TYPE, 
-    "^(\\w+)\\s+\\$(\\w+)[\\s|,]+\\$(\\w+)[\\s|,]+(\\w+)$",
     {
-        {1, ISA::Field::OPCODE},
-        {2, ISA::Field::RT},
-        {3, ISA::Field::RS},
-        {4, ISA::Field::IMM}
-    }
+        {ISA::Field::RT, Assembler::Operand::REGISTER, ""},
+        {ISA::Field::RS, Assembler::Operand::REGISTER, "|,"},
+        {ISA::Field::IMM, Assembler::Operand::IMMEDIATE, "|,"}
+    },
+    ""
 };
+// op $rs $rt offset, offset either immediate or label
 const Assembler::Decoder Assembler::I_TYPE_Decoder_2 = {
     ISA::Type::I_TYPE, 
-    "^(\\w+)\\s+\\$(\\w+)[\\s|,]+\\$(\\w+)[\\s|,]+(\\w+)$",
     {
-        {1, ISA::Field::OPCODE},
-        {2, ISA::Field::RS},
-        {3, ISA::Field::RT},
-        {4, ISA::Field::IMM}
-    }
+        {ISA::Field::RS, Assembler::Operand::REGISTER, ""},
+        {ISA::Field::RT, Assembler::Operand::REGISTER, "|,"},
+        {ISA::Field::IMM, Assembler::Operand::OFFSET, "|,"}
+    },
+    ""
 };
+// op $rt imm
 const Assembler::Decoder Assembler::I_TYPE_Decoder_3 = {
     ISA::Type::I_TYPE, 
-    "^(\\w+)\\s+\\$(\\w+)[\\s|,]+(\\w+)$",
     {
-        {1, ISA::Field::OPCODE},
-        {2, ISA::Field::RT},
-        {3, ISA::Field::IMM}
-    }
+        {ISA::Field::RT, Assembler::Operand::REGISTER, ""},
+        {ISA::Field::IMM, Assembler::Operand::IMMEDIATE, "|,"}
+    },
+    ""
 };
+// op $rt imm $rs, or op $rt imm($rs)
 const Assembler::Decoder Assembler::I_TYPE_Decoder_4 = {
     ISA::Type::I_TYPE, 
-    "^(\\w+)\\s+\\$(\\w+)[\\s|,]+(\\w+)[\\s|\\(]+\\$(\\w+)[\\s|\\)]*$",
     {
-        {1, ISA::Field::OPCODE},
-        {2, ISA::Field::RT},
-        {3, ISA::Field::IMM},
-        {4, ISA::Field::RS}
-    }
+        {ISA::Field::RT, Assembler::Operand::REGISTER, ""},
+        {ISA::Field::IMM, Assembler::Operand::IMMEDIATE, "|,"},
+        {ISA::Field::RS, Assembler::Operand::REGISTER, "|("}
+    },
+    "|)"
 };
 // 3. decoders:
 const std::map<std::string, const Assembler::Decoder&> Assembler::INSTRUCTION_DECODER = {
@@ -133,24 +247,85 @@ const std::map<std::string, const Assembler::Decoder&> Assembler::INSTRUCTION_DE
     {   "sw", I_TYPE_Decoder_4}
 };
 
-Assembler::Assembler(const std::string &input_filename, std::uint32_t text_starting_addr): TEXT_STARTING_ADDR(text_starting_addr) {
+Assembler::Assembler(std::uint32_t text_starting_addr, std::size_t jobs):
+    num_errors(0),
+    first_line(0),
+    first_instruction(0),
+    TEXT_STARTING_ADDR(text_starting_addr),
+    JOBS((0 == jobs) ? std::max(1u, std::thread::hardware_concurrency()) : jobs) {
+}
+
+Assembler::Assembler(
+    const std::string &input_filename, std::uint32_t text_starting_addr, std::size_t jobs,
+    bool schedule, bool fill_delay_slots
+):
+    Assembler(text_starting_addr, jobs) {
     // load instructions:
     load(input_filename);
 
+    assemble(schedule, fill_delay_slots);
+}
+
+/**
+    Assemble ASM source text held in memory.
+
+    @param source input ASM source text, only read during assembly.
+    @param text_starting_addr address of first instruction.
+    @param jobs number of worker threads for normalization & encoding, 0 for one per hardware thread.
+    @param schedule reorder independent instructions inside basic blocks to reduce data hazard stalls.
+    @param fill_delay_slots insert a delay slot behind every branch, filled with an independent instruction where safe.
+    @return assembler of source text.
+*/
+Assembler Assembler::from_source(
+    std::string_view source, std::uint32_t text_starting_addr, std::size_t jobs,
+    bool schedule, bool fill_delay_slots
+) {
+    Assembler assembler(text_starting_addr, jobs);
+
+    assembler.split(source);
+    assembler.assemble(schedule, fill_delay_slots);
+
+    return assembler;
+}
+
+/**
+    Parse loaded lines, optionally schedule & fill delay slots, then build text segment.
+
+    @param schedule reorder independent instructions inside basic blocks to reduce data hazard stalls.
+    @param fill_delay_slots insert a delay slot behind every branch, filled with an independent instruction where safe.
+*/
+void Assembler::assemble(bool schedule, bool fill_delay_slots) {
     // parse instructions into machine code:
     parse();
 
+    // optionally separate dependent instructions:
+    if (schedule && !machine_codes.empty()) {
+        this->schedule();
+    }
+
+    // optionally move independent instructions into delay slots, behind scheduling:
+    if (fill_delay_slots && !machine_codes.empty()) {
+        this->fill_delay_slots();
+    }
+
     // build instruction memory image:
     build();
+
+    // release input, slices are no longer needed:
+    instructions.clear();
+    source.reset();
 }
 
 /**
     Dump parsed machine code to output file.
     for online validation, please go to https://www.eg.bucknell.edu/%7Ecsci320/mips_web/
 
+    @param text text segment.
     @param output_filename output filename.    
 */
-void Assembler::dump(const std::string &output_filename) {
+void Assembler::dump(ISA::TextSegment &text, const std::string &output_filename) {
+    HOST_TIMER(REPORT_DUMP);
+
     std::ofstream output_machine_code(output_filename);
 
 	if(!output_machine_code) {
@@ -159,14 +334,14 @@ void Assembler::dump(const std::string &output_filename) {
 	}
 
     for (
-        ISA::Address address = text_segment.get_address_first();
-        text_segment.get_address_last() >= address;
+        ISA::Address address = text.get_address_first();
+        text.get_address_last() >= address;
         address += 0x00000004
     ) {
         output_machine_code << "0x" << std::setfill('0') << std::setw(8) << std::hex << address;
         output_machine_code << ": ";
-        output_machine_code << "0x" << std::setfill('0') << std::setw(8) << std::hex << text_segment.get_binary(address);
-        output_machine_code << ";\t" << text_segment.get_text(address);
+        output_machine_code << "0x" << std::setfill('0') << std::setw(8) << std::hex << text.get_binary(address);
+        output_machine_code << ";\t" << text.get_text(address);
         output_machine_code << std::endl;
     }
     
@@ -174,69 +349,256 @@ void Assembler::dump(const std::string &output_filename) {
 	output_machine_code.close(); 
 }
 /**
-    Normalize each instruction before parsing.
+    Dump symbol map, one label per line in address order.
+
+    @param symbols symbol table, label to instruction address.
+    @param output_filename output filename.
+*/
+void Assembler::dump_symbols(const std::unordered_map<std::string, ISA::Address> &symbols, const std::string &output_filename) {
+    HOST_TIMER(REPORT_DUMP);
+
+    std::ofstream output_symbols(output_filename);
+
+    if (!output_symbols) {
+        std::cerr << "[MIPS simulator]: ERROR -- cannot open output symbol map file "<< output_filename <<std::endl;
+        return;
+    }
+
+    std::vector<std::pair<ISA::Address, std::string>> ordered;
+    for (const auto &symbol: symbols) {
+        ordered.push_back({symbol.second, symbol.first});
+    }
+    std::sort(ordered.begin(), ordered.end());
+
+    for (const auto &symbol: ordered) {
+        output_symbols << "0x" << std::setfill('0') << std::setw(8) << std::hex << symbol.first;
+        output_symbols << ": " << symbol.second << std::endl;
+    }
+
+    output_symbols.close();
+}
+
+/**
+    Dump binary program image with line & symbol tables, loadable without assembly.
+
+    @param output_filename output filename.
+*/
+void Assembler::dump_image(const std::string &output_filename) {
+    HOST_TIMER(REPORT_DUMP);
+
+    std::vector<std::uint32_t> lines;
+    lines.reserve(locations.size());
+    for (const auto &location: locations) {
+        lines.push_back(location.line);
+    }
+
+    try {
+        ProgramImage::write(output_filename, text_segment, lines, symbols);
+    } catch (const std::runtime_error &e) {
+        std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << std::endl;
+    }
+}
+
+/**
+    Fingerprint input ASM for content-addressed caching, FNV-1a over source, assembler version, text address, scheduling & delay slots.
+
+    @param input_filename input ASM filename.
+    @param text_starting_addr address of first instruction.
+    @param schedule whether instructions are scheduled.
+    @param fill_delay_slots whether delay slots are inserted behind branches.
+    @return 16 hex digit fingerprint, empty if input cannot be read.
+*/
+std::string Assembler::fingerprint(
+    const std::string &input_filename, std::uint32_t text_starting_addr,
+    bool schedule, bool fill_delay_slots
+) {
+    std::unique_ptr<PipelineTrace::MappedFile> input;
+    try {
+        input.reset(new PipelineTrace::MappedFile(input_filename));
+    } catch (const std::runtime_error &) {
+        return "";
+    }
+
+    std::uint64_t hash = 0xcbf29ce484222325;
+    const auto update = [&hash](const char *data, std::size_t size) {
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x00000100000001b3;
+        }
+    };
+    update(input->data(), input->size());
+    const std::uint32_t version = VERSION;
+    update(reinterpret_cast<const char *>(&version), sizeof(version));
+    update(reinterpret_cast<const char *>(&text_starting_addr), sizeof(text_starting_addr));
+    if (schedule) {
+        // unscheduled keys stay as they were:
+        update("schedule", 8);
+    }
+    if (fill_delay_slots) {
+        update("delay slots", 11);
+    }
+
+    std::ostringstream key;
+    key << std::hex << std::setfill('0') << std::setw(16) << hash;
+
+    return key.str();
+}
+
+/**
+    Assemble input ASM straight into a binary program image with bounded memory, for inputs too large to retain.
+    Labels are collected by a first streaming pass, then lines are encoded & written block by block.
+    The image carries no source text, which optionally goes to a sidecar line table instead.
+
+    @param input_filename input ASM filename.
+    @param output_filename output program image filename.
+    @param lines_filename sidecar line table filename, "address<TAB>line<TAB>text" per instruction, empty to skip.
+    @param text_starting_addr address of first instruction.
+    @param jobs number of worker threads for normalization & encoding, 0 for one per hardware thread.
+    @return number of instructions.
+*/
+std::size_t Assembler::stream(
+    const std::string &input_filename,
+    const std::string &output_filename,
+    const std::string &lines_filename,
+    std::uint32_t text_starting_addr,
+    std::size_t jobs
+) {
+    Assembler assembler(text_starting_addr, jobs);
+
+    std::ifstream input(input_filename);
+    if (!input) {
+        throw std::runtime_error("cannot open input ASM file " + input_filename);
+    }
+
+    // a. first pass -- define labels & count instructions, one line at a time:
+    std::size_t N = 0;
+    {
+        HOST_TIMER(ASSEMBLER_LOAD);
+
+        std::string line;
+        for (std::size_t i = 0; std::getline(input, line); ++i) {
+            std::string_view instruction = line;
+            if (assembler.normalize(instruction)) {
+                SourceLocation location = {i + 1, static_cast<std::size_t>(instruction.data() - line.data()) + 1};
+                if (assembler.define_label(instruction, location, text_starting_addr + (N << 2))) {
+                    ++N;
+                }
+            }
+        }
+    }
+
+    std::ofstream lines;
+    if (!lines_filename.empty()) {
+        lines.open(lines_filename);
+        if (!lines) {
+            throw std::runtime_error("cannot open output line table file " + lines_filename);
+        }
+    }
+    ProgramImageWriter writer(output_filename, N, assembler.symbols);
+
+    // b. second pass -- encode & write one block of lines at a time, labels already defined:
+    input.clear();
+    input.seekg(0);
+    std::vector<std::string> block(STREAM_BLOCK_LINES);
+    while (input) {
+        std::size_t num_lines = 0;
+        while (num_lines < STREAM_BLOCK_LINES && std::getline(input, block[num_lines])) {
+            ++num_lines;
+        }
+
+        assembler.instructions.assign(block.begin(), block.begin() + num_lines);
+        assembler.parse(false);
+
+        HOST_TIMER(ASSEMBLER_BUILD);
+        for (std::size_t i = 0; i < assembler.machine_codes.size(); ++i) {
+            const ISA::Address address = text_starting_addr + ((assembler.first_instruction + i) << 2);
+            writer.append(address, assembler.machine_codes[i], assembler.locations[i].line);
+
+            if (lines.is_open()) {
+                lines << "0x" << std::setfill('0') << std::setw(8) << std::hex << address;
+                lines << "\t" << std::dec << assembler.locations[i].line << "\t" << to_lower(assembler.instructions[i]) << "\n";
+            }
+        }
+
+        assembler.first_line += num_lines;
+        assembler.first_instruction += assembler.machine_codes.size();
+    }
+    writer.close();
+
+    if (lines.is_open() && !lines) {
+        throw std::runtime_error("cannot write output line table file " + lines_filename);
+    }
+
+    return N;
+}
+
+/**
+    Normalize each instruction before parsing, by narrowing the slice.
 
     @param instruction input instruction.
     @return true for valid instruction otherwise false.
 */
-bool Assembler::normalize(std::string &instruction) {
+bool Assembler::normalize(std::string_view &instruction) {
     // a. remove comments:
     std::size_t found = instruction.find("//");
-    if (std::string::npos != found) {
-        instruction.erase(found, std::string::npos);
+    if (std::string_view::npos != found) {
+        instruction.remove_suffix(instruction.size() - found);
     }
     if (0 == instruction.size()) {return false;}
 
     // b. remove left & right hand side whitespaces:
     // left trim:
-    instruction.erase(
-        instruction.begin(), std::find_if(
-            instruction.begin(), instruction.end(), 
-            [](int ch) {return !std::isspace(ch);}
-        )
-    );
+    while (!instruction.empty() && std::isspace(static_cast<unsigned char>(instruction.front()))) {
+        instruction.remove_prefix(1);
+    }
     if (0 == instruction.size()) {return false;}
 
     // right trim:
-    instruction.erase(
-        std::find_if(
-            instruction.rbegin(), instruction.rend(), 
-            [](int ch) {return !std::isspace(ch);}
-        ).base(), 
-        instruction.end()
-    );
+    while (!instruction.empty() && std::isspace(static_cast<unsigned char>(instruction.back()))) {
+        instruction.remove_suffix(1);
+    }
 
-    // c. to lowercase:
-    std::transform(instruction.begin(), instruction.end(), instruction.begin(), ::tolower);
+    // c. to lowercase -- deferred to kept & reported text, the parser is case-insensitive:
 
     return (0 != instruction.size());
 }
 
 /**
-    Load instructions from input ASM.
+    Map input ASM & split it into raw lines, without copying.
 
     @param input_filename input ASM filename.
 */
 void Assembler::load(const std::string &input_filename) {
-	// open input file:
-	std::ifstream input_asm(input_filename);
-	if(!input_asm) {
-		std::cerr << "[MIPS simulator]: ERROR -- cannot open input ASM file "<< input_filename <<std::endl;
+    HOST_TIMER(ASSEMBLER_LOAD);
+
+	// map input file:
+    try {
+        source.reset(new PipelineTrace::MappedFile(input_filename));
+    } catch (const std::runtime_error &) {
+        report_error("[MIPS simulator]: ERROR -- cannot open input ASM file " + input_filename + "\n");
         return; 
 	}
  
-	// read instruction line by line:
-	std::string instruction;
-	while (std::getline(input_asm, instruction)) {
-        // if get a valid instruction:
-        if (normalize(instruction)) {
-            // save instruction:••••••••
-            instructions.push_back(instruction);
-        }  
-	}
+    split(std::string_view(source->data(), source->size()));
+}
 
-	// close input file:
-	input_asm.close();   
+/**
+    Split input into raw lines, without copying.
+
+    @param input input ASM source text.
+*/
+void Assembler::split(std::string_view input) {
+	// split line by line, normalized later by parse:
+    const char *begin = input.data();
+    const char *const END = begin + input.size();
+    instructions.reserve(std::count(begin, END, '\n') + 1);
+	while (begin < END) {
+        const char *end = static_cast<const char *>(std::memchr(begin, '\n', END - begin));
+        if (nullptr == end) {
+            end = END;
+        }
+        instructions.emplace_back(begin, end - begin);
+        begin = end + 1;
+	}
 }
 
 /**
@@ -290,89 +652,464 @@ void Assembler::set_opcode(
 /**
     Set other fields (rs, rt, rd, shamt & imm) for instruction.
 
-    @param instruction instruction statement.
+    @param index instruction index.
+    @param begin position of first operand separator inside instruction.
     @param decoder instruction decoder.
     @param machine_code output machine code reference.
+    @param log syntax error output.
+    @return true on success, false on syntax error.
 */
-void Assembler::set_fields(
-    const std::string &instruction, 
+bool Assembler::set_fields(
+    std::size_t index,
+    std::size_t begin,
     const Assembler::Decoder& decoder, 
-    ISA::MachineCode &machine_code
+    ISA::MachineCode &machine_code,
+    std::ostream &log
 ) {
-    std::regex pattern(decoder.regex);
-    std::smatch matches;
-
-    if(std::regex_search(instruction, matches, pattern)) {
-        for (size_t i = 1; i < matches.size(); ++i) {
-            auto group_name = decoder.group_name.find(i)->second;
-            auto value = matches[i].str();
-            switch (group_name) {
-                case ISA::Field::RS:
-                    ISA::set_instruction_field(machine_code, ISA::Field::RS, ISA::REGISTER_FILE.find(value)->second);
-                    break;
-                case ISA::Field::RT:
-                    ISA::set_instruction_field(machine_code, ISA::Field::RT, ISA::REGISTER_FILE.find(value)->second);
-                    break;
-                case ISA::Field::RD:
-                    ISA::set_instruction_field(machine_code, ISA::Field::RD, ISA::REGISTER_FILE.find(value)->second);
-                    break;
-                case ISA::Field::SHAMT:
-                    ISA::set_instruction_field(machine_code, ISA::Field::SHAMT, std::stoi(value, nullptr, 16));
-                    break;
-                case ISA::Field::IMM:
-                    ISA::set_instruction_field(machine_code, ISA::Field::IMM, std::stoi(value, nullptr, 16));
-                    break;
-                default:
-                    break;
+    const std::string_view instruction = instructions[index];
+    const std::size_t N = instruction.size();
+    std::size_t i = begin;
+
+    for (const auto &operand: decoder.operands) {
+        // a. separator:
+        const std::size_t separator_begin = i;
+        while (i < N && is_separator(instruction[i], operand.separator)) {
+            ++i;
+        }
+        if (separator_begin == i) {
+            return error(index, i, (i < N) ? std::string("unexpected '") + instruction[i] + "'" : "missing operand", log);
+        }
+
+        // b. operand token:
+        if (Operand::REGISTER == operand.kind) {
+            if (N <= i || '$' != instruction[i]) {
+                return error(index, i, "expected register", log);
+            }
+            const std::size_t name_begin = ++i;
+            while (i < N && is_word(instruction[i])) {
+                ++i;
+            }
+
+            const int address = find_register(instruction.data() + name_begin, i - name_begin);
+            if (0 > address) {
+                return error(index, name_begin - 1, "unknown register '$" + to_lower(instruction.substr(name_begin, i - name_begin)) + "'", log);
+            }
+            ISA::set_instruction_field(machine_code, operand.field, address);
+        } else {
+            const std::size_t value_begin = i;
+            while (i < N && is_word(instruction[i])) {
+                ++i;
+            }
+            if (value_begin == i) {
+                return error(index, i, "expected immediate", log);
             }
+
+            // branch offset to label, in instructions relative to next one:
+            if (Operand::OFFSET == operand.kind && !std::isdigit(static_cast<unsigned char>(instruction[value_begin]))) {
+                const std::string label = to_lower(instruction.substr(value_begin, i - value_begin));
+                auto symbol = symbols.find(label);
+                if (symbols.end() == symbol) {
+                    return error(index, value_begin, "undefined label '" + label + "'", log);
+                }
+
+                const std::int64_t next = TEXT_STARTING_ADDR + ((first_instruction + index + 1) << 2);
+                const std::int64_t offset = (static_cast<std::int64_t>(symbol->second) - next) / 4;
+                if (offset < -0x8000 || 0x7FFF < offset) {
+                    return error(index, value_begin, "branch to '" + label + "' out of range", log);
+                }
+                ISA::set_instruction_field(machine_code, operand.field, static_cast<ISA::Word>(offset));
+                continue;
+            }
+
+            // hexadecimal, with optional 0x prefix:
+            std::size_t j = value_begin;
+            if (2 < i - j && '0' == instruction[j] && 'x' == lower(instruction[j + 1])) {
+                j += 2;
+            }
+            std::uint64_t value = 0;
+            for (; j < i; ++j) {
+                const char ch = lower(instruction[j]);
+                if (!std::isxdigit(static_cast<unsigned char>(ch))) {
+                    return error(index, j, std::string("invalid hexadecimal digit '") + ch + "'", log);
+                }
+                value = (value << 4) | (std::isdigit(static_cast<unsigned char>(ch)) ? ch - '0' : ch - 'a' + 10);
+                if (0xFFFFFFFF < value) {
+                    return error(index, value_begin, "immediate out of range", log);
+                }
+            }
+            ISA::set_instruction_field(machine_code, operand.field, static_cast<ISA::Word>(value));
         }
+    }
+
+    // c. trailer:
+    while (i < N && is_separator(instruction[i], decoder.trailer)) {
+        ++i;
+    }
+    if (i < N) {
+        return error(index, i, std::string("unexpected '") + instruction[i] + "'", log);
+    }
+
+    return true;
+}
+
+/**
+    Report syntax error at instruction position.
+
+    @param index instruction index.
+    @param position position inside normalized instruction.
+    @param message error message.
+    @param log syntax error output.
+    @return false.
+*/
+bool Assembler::error(std::size_t index, std::size_t position, const std::string &message, std::ostream &log) {
+    return error(locations[index], instructions[index], position, message, log);
+}
+
+bool Assembler::error(
+    const SourceLocation &location, std::string_view instruction,
+    std::size_t position, const std::string &message, std::ostream &log
+) {
+    log << "[MIPS simulator]: Assembler -- syntax error at line " << location.line << ", column " << location.column + position << " -- " << message << std::endl;
+    log << "\t" << to_lower(instruction) << std::endl;
+    log << "\t" << std::string(position, ' ') << "^" << std::endl;
+
+    return false;
+}
+
+/**
+    Strip leading label from normalized instruction and define it.
+
+    @param instruction normalized instruction, label removed in place.
+    @param location instruction position, column moved past label.
+    @param address address of next instruction.
+    @param define false to strip only, for labels already defined.
+    @return true when an instruction follows otherwise false.
+*/
+bool Assembler::define_label(std::string_view &instruction, SourceLocation &location, ISA::Address address, bool define) {
+    // a. label -- word starting with letter or underscore, followed by colon:
+    std::size_t end = 0;
+    while (end < instruction.size() && is_word(instruction[end])) {
+        ++end;
+    }
+    if (0 == end || instruction.size() == end || ':' != instruction[end] || std::isdigit(static_cast<unsigned char>(instruction[0]))) {
+        return true;
+    }
+
+    // b. define, first definition wins:
+    const std::string label = to_lower(instruction.substr(0, end));
+    if (define && !symbols.insert({label, address}).second) {
+        std::ostringstream log;
+        error(location, instruction, 0, "duplicate label '" + label + "'", log);
+        label_diagnostics.push_back({location.line, log.str()});
+    }
+
+    // c. strip label:
+    const std::size_t next = instruction.find_first_not_of(" \t\n\v\f\r", end + 1);
+    if (std::string_view::npos == next) {
+        return false;
+    }
+    instruction.remove_prefix(next);
+    location.column += next;
+
+    return true;
+}
+
+/**
+    Encode one normalized instruction.
+
+    @param index instruction index.
+    @param log syntax error output.
+    @return machine code, operation only on syntax error.
+*/
+ISA::MachineCode Assembler::encode(std::size_t index, std::ostream &log) {
+    const std::string_view instruction = instructions[index];
+
+    // parse operation:
+    std::size_t end = 0;
+    while (end < instruction.size() && is_word(instruction[end])) {
+        ++end;
+    }
+    const std::string operation = to_lower(instruction.substr(0, end));
+    auto result = INSTRUCTION_DECODER.find(operation);
+
+    // init machine code:
+    ISA::MachineCode machine_code = 0x00000000;
+
+    if (0 == end) {
+        // keep text segment aligned with instructions, as nop:
+        error(index, 0, "expected operation", log);
+    } else if (INSTRUCTION_DECODER.end() == result) {
+        error(index, 0, "unknown operation '" + operation + "'", log);
     } else {
-        std::cout << instruction << std::endl;
-        std::cout << "\t" << decoder.regex << std::endl;
-        std::cout << "\t" << "MATCH FAILED" << std::endl;
-        std::cout <<  std::endl;
+        // get decoder handler:
+        const Assembler::Decoder& decoder = result->second;
+
+        // set opcode:
+        set_opcode(operation, decoder, machine_code);
+
+        // set other fields, operation only on syntax error:
+        ISA::MachineCode fields = 0x00000000;
+        if (set_fields(index, end, decoder, fields, log)) {
+            machine_code |= fields;
+        }
     }
+
+    return machine_code;
 }
 
 /**
-    Parse instructions into machine code.
+    Normalize lines & parse instructions into machine code, in parallel over contiguous chunks of input.
+
+    @param define_labels false when labels were defined by an earlier pass.
 */
-void Assembler::parse(void) {
-    for (const auto &instruction: instructions) {
-        // parse operation:
-        auto operation = instruction.substr(0, instruction.find(" "));
-        auto result = INSTRUCTION_DECODER.find(operation);
-        if (INSTRUCTION_DECODER.end() != result) {
-            // get decoder handler:
-            const Assembler::Decoder& decoder = result->second;
-
-            // init machine code:
-            ISA::MachineCode machine_code = 0x00000000;
-
-            // set opcode:
-            set_opcode(operation, decoder, machine_code);
-
-            // set other fields:
-            set_fields(instruction, decoder, machine_code);
-
-            // save parsed machine code:
-            machine_codes.push_back(machine_code);
+void Assembler::parse(bool define_labels) {
+    HOST_TIMER(ASSEMBLER_PARSE);
+
+    // a. normalize line slices, recording first column:
+    const std::size_t NUM_LINES = instructions.size();
+    std::vector<std::size_t> columns(NUM_LINES);
+    std::vector<std::uint8_t> valid(NUM_LINES);
+    for_each_chunk(
+        NUM_LINES, JOBS,
+        [this, &columns, &valid](std::size_t, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const char *line = instructions[i].data();
+                valid[i] = normalize(instructions[i]);
+                columns[i] = instructions[i].data() - line + 1;
+            }
+        }
+    );
+
+    // b. first pass -- define labels, keep valid instructions & their positions, in order:
+    std::size_t N = 0;
+    locations.clear();
+    for (std::size_t i = 0; i < NUM_LINES; ++i) {
+        SourceLocation location = {first_line + i + 1, columns[i]};
+        if (valid[i] && define_label(instructions[i], location, TEXT_STARTING_ADDR + ((first_instruction + N) << 2), define_labels)) {
+            locations.push_back(location);
+            if (N != i) {
+                instructions[N] = instructions[i];
+            }
+            ++N;
+        }
+    }
+    instructions.resize(N);
+
+    // c. second pass -- encode instructions with labels resolved, syntax errors buffered per chunk:
+    machine_codes.resize(N);
+    std::vector<std::vector<Diagnostic>> diagnostics(JOBS);
+    for_each_chunk(
+        N, JOBS,
+        [this, &diagnostics](std::size_t chunk, std::size_t begin, std::size_t end) {
+            std::ostringstream log;
+            for (std::size_t i = begin; i < end; ++i) {
+                machine_codes[i] = encode(i, log);
+                if (0 != log.tellp()) {
+                    diagnostics[chunk].push_back({locations[i].line, log.str()});
+                    log.str("");
+                }
+            }
+        }
+    );
+
+    // d. duplicate labels & syntax errors in input order:
+    report(diagnostics, first_line + NUM_LINES);
+}
+
+/**
+    Report duplicate labels & buffered syntax errors up to last line, in input order.
+
+    @param diagnostics syntax errors, one sorted list per chunk.
+    @param last_line last input ASM line covered.
+*/
+void Assembler::report(const std::vector<std::vector<Diagnostic>> &diagnostics, std::size_t last_line) {
+    // a. duplicate labels of covered lines, defined by this or an earlier streaming pass:
+    std::size_t num_labels = 0;
+    while (num_labels < label_diagnostics.size() && label_diagnostics[num_labels].line <= last_line) {
+        ++num_labels;
+    }
+
+    // b. merge, a label before the instruction on its line:
+    std::size_t label = 0;
+    for (const auto &chunk: diagnostics) {
+        for (const auto &diagnostic: chunk) {
+            for (; label < num_labels && label_diagnostics[label].line <= diagnostic.line; ++label) {
+                report_error(label_diagnostics[label].message);
+            }
+            report_error(diagnostic.message);
+        }
+    }
+    for (; label < num_labels; ++label) {
+        report_error(label_diagnostics[label].message);
+    }
+
+    label_diagnostics.erase(label_diagnostics.begin(), label_diagnostics.begin() + num_labels);
+}
+
+/**
+    Write error report to std::cerr & keep it.
+
+    @param message error report.
+*/
+void Assembler::report_error(const std::string &message) {
+    std::cerr << message;
+
+    errors += message;
+    ++num_errors;
+}
+
+/**
+    Get basic block leaders -- labels & branch targets.
+*/
+std::vector<bool> Assembler::get_leaders(void) const {
+    const std::size_t N = machine_codes.size();
+
+    std::vector<bool> leaders(N, false);
+    for (const auto &symbol: symbols) {
+        const std::size_t index = (symbol.second - TEXT_STARTING_ADDR) >> 2;
+        if (index < N) {
+            leaders[index] = true;
+        }
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+        if (ISA::OpCode::BEQ == ISA::get_instruction_field(machine_codes[i], ISA::Field::OPCODE)) {
+            const std::int16_t offset = ISA::get_instruction_field(machine_codes[i], ISA::Field::IMM);
+            const std::int64_t target = std::int64_t(i) + 1 + offset;
+            if (0 <= target && target < std::int64_t(N)) {
+                leaders[target] = true;
+            }
         }
     }
+
+    return leaders;
+}
+
+/**
+    Reorder independent instructions inside basic blocks to separate RAW-dependent pairs,
+    labels & branches staying in place. Reports predicted data hazard stalls.
+*/
+void Assembler::schedule(void) {
+    HOST_TIMER(ASSEMBLER_SCHEDULE);
+
+    const std::size_t N = machine_codes.size();
+
+    // a. basic block leaders:
+    const std::vector<bool> leaders = get_leaders();
+
+    // b. reorder instructions together with their source text & positions:
+    Scheduler::Report report;
+    const std::vector<std::size_t> order = Scheduler::schedule(machine_codes, leaders, report);
+
+    std::vector<std::string_view> scheduled_instructions(N);
+    std::vector<SourceLocation> scheduled_locations(N);
+    std::vector<ISA::MachineCode> scheduled_machine_codes(N);
+    for (std::size_t i = 0; i < N; ++i) {
+        scheduled_instructions[i] = instructions[order[i]];
+        scheduled_locations[i] = locations[order[i]];
+        scheduled_machine_codes[i] = machine_codes[order[i]];
+    }
+    instructions.swap(scheduled_instructions);
+    locations.swap(scheduled_locations);
+    machine_codes.swap(scheduled_machine_codes);
+
+    // c. report:
+    const auto stalls = [](std::uint64_t cycles) {
+        return (Scheduler::DEADLOCK == cycles) ? std::string("deadlock") : std::to_string(cycles);
+    };
+    std::clog << "[MIPS simulator]: Assembler -- scheduler -- " << report.reordered << " of " << report.blocks << " basic blocks reordered, ";
+    std::clog << "predicted data hazard stalls " << stalls(report.stalls_before) << " -> " << stalls(report.stalls_after) << std::endl;
+}
+
+/**
+    Insert a delay slot behind every branch, filled with an instruction moved down from above the branch
+    or a nop. Labels & branch offsets are relocated. Reports filled slots.
+*/
+void Assembler::fill_delay_slots(void) {
+    HOST_TIMER(ASSEMBLER_FILL_DELAY_SLOTS);
+
+    static const std::string_view NOP_TEXT("sll $zero $zero 0x00");
+
+    const std::size_t N = machine_codes.size();
+
+    // a. layout -- moved instructions never carry a label & are never branched to:
+    Scheduler::DelaySlotReport report;
+    const std::vector<std::size_t> layout = Scheduler::fill_delay_slots(machine_codes, get_leaders(), report);
+    const std::size_t M = layout.size();
+
+    std::vector<std::size_t> position(N + 1);
+    std::vector<std::string_view> laid_out_instructions(M);
+    std::vector<SourceLocation> laid_out_locations(M);
+    std::vector<ISA::MachineCode> laid_out_machine_codes(M);
+    for (std::size_t i = 0; i < M; ++i) {
+        if (Scheduler::NOP == layout[i]) {
+            // empty slot, reported at its branch:
+            laid_out_instructions[i] = NOP_TEXT;
+            laid_out_locations[i] = laid_out_locations[i - 1];
+            laid_out_machine_codes[i] = Scheduler::NOP_MACHINE_CODE;
+        } else {
+            position[layout[i]] = i;
+            laid_out_instructions[i] = instructions[layout[i]];
+            laid_out_locations[i] = locations[layout[i]];
+            laid_out_machine_codes[i] = machine_codes[layout[i]];
+        }
+    }
+    position[N] = M;
+    instructions.swap(laid_out_instructions);
+    locations.swap(laid_out_locations);
+    machine_codes.swap(laid_out_machine_codes);
+
+    // b. relocate labels & branch offsets, targets outside text segment keep their distance to it:
+    const auto relocate = [&position, N, M](std::int64_t index) -> std::int64_t {
+        if (index < 0) {
+            return index;
+        }
+        return (std::int64_t(N) < index) ? index - N + M : position[index];
+    };
+    for (auto &symbol: symbols) {
+        symbol.second = TEXT_STARTING_ADDR + (relocate((symbol.second - TEXT_STARTING_ADDR) >> 2) << 2);
+    }
+    for (std::size_t i = 0; i < M; ++i) {
+        if (Scheduler::NOP == layout[i] || ISA::OpCode::BEQ != ISA::get_instruction_field(machine_codes[i], ISA::Field::OPCODE)) {
+            continue;
+        }
+
+        const std::int16_t offset = ISA::get_instruction_field(machine_codes[i], ISA::Field::IMM);
+        const std::int64_t relocated = relocate(std::int64_t(layout[i]) + 1 + offset) - std::int64_t(i + 1);
+        if (relocated < -0x8000 || 0x7FFF < relocated) {
+            std::ostringstream log;
+            error(i, 0, "branch out of range behind delay slots", log);
+            report_error(log.str());
+            continue;
+        }
+        machine_codes[i] &= 0xFFFF0000;
+        ISA::set_instruction_field(machine_codes[i], ISA::Field::IMM, static_cast<ISA::Word>(relocated));
+    }
+
+    // c. report:
+    std::clog << "[MIPS simulator]: Assembler -- delay slots -- " << report.filled << " of " << report.slots << " filled, ";
+    std::clog << (report.slots - report.filled) << " nops inserted" << std::endl;
 }
 
 /**
     Build instruction memory image.
 */
 void Assembler::build(void) {
+    HOST_TIMER(ASSEMBLER_BUILD);
+
+    std::string text;
     for (std::size_t i = 0; i < machine_codes.size(); ++i) {
-        // update image:
-        text_segment.set(TEXT_STARTING_ADDR + (i << 2), {machine_codes[i], instructions[i]});
+        // update image, lowered through one reused buffer:
+        text.assign(instructions[i]);
+        std::transform(text.begin(), text.end(), text.begin(), lower);
+        text_segment.set(TEXT_STARTING_ADDR + (i << 2), machine_codes[i], text);
+    }
+    if (text_segment.is_empty()) {
+        return;
     }
 
-    std::cout << "[MIPS simulator]: Assembler -- text segment [";
-    std::cout << "0x" << std::setfill('0') << std::setw(8) << std::hex << text_segment.get_address_first();
-    std::cout << ", ";
-    std::cout << "0x" << std::setfill('0') << std::setw(8) << std::hex << text_segment.get_address_last();
-    std::cout << "]" << std::endl;
+    std::clog << "[MIPS simulator]: Assembler -- text segment [";
+    std::clog << "0x" << std::setfill('0') << std::setw(8) << std::hex << text_segment.get_address_first();
+    std::clog << ", ";
+    std::clog << "0x" << std::setfill('0') << std::setw(8) << std::hex << text_segment.get_address_last();
+    std::clog << std::dec << "]" << std::endl;
 }
\ No newline at end of file
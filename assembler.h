@@ -3,32 +3,143 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory>
 #include <map>
+#include <unordered_map>
 #include <cstdio>
 #include <cinttypes>
 
 #include "isa.h"
+#include "pipeline_trace.h"
 
 /**
  *  MIPS ASM assembler.
  */
 class Assembler {
 public:
-    Assembler(const std::string &input_filename, std::uint32_t text_starting_addr = 0x00400000);
+    // encoding version, bump on any change of machine code or text output to invalidate cached program images:
+    static const std::uint32_t VERSION = 1;
+
+    /**
+        @param input_filename input ASM filename.
+        @param text_starting_addr address of first instruction.
+        @param jobs number of worker threads for normalization & encoding, 0 for one per hardware thread.
+        @param schedule reorder independent instructions inside basic blocks to reduce data hazard stalls.
+        @param fill_delay_slots insert a delay slot behind every branch, filled with an independent instruction where safe.
+    */
+    Assembler(
+        const std::string &input_filename, std::uint32_t text_starting_addr = 0x00400000, std::size_t jobs = 1,
+        bool schedule = false, bool fill_delay_slots = false
+    );
+
+    /**
+        Assemble ASM source text held in memory.
+
+        @param source input ASM source text, only read during assembly.
+        @param text_starting_addr address of first instruction.
+        @param jobs number of worker threads for normalization & encoding, 0 for one per hardware thread.
+        @param schedule reorder independent instructions inside basic blocks to reduce data hazard stalls.
+        @param fill_delay_slots insert a delay slot behind every branch, filled with an independent instruction where safe.
+        @return assembler of source text.
+    */
+    static Assembler from_source(
+        std::string_view source, std::uint32_t text_starting_addr = 0x00400000, std::size_t jobs = 1,
+        bool schedule = false, bool fill_delay_slots = false
+    );
 
     /**
         Get built text segment    
     */
     ISA::TextSegment get_text_segment(void) {return text_segment;}
 
+    /**
+        Get number of errors reported during assembly, syntax errors & unreadable input.
+    */
+    std::size_t get_num_errors(void) const {return num_errors;}
+
+    /**
+        Get error reports, as written to std::cerr in input order.
+    */
+    const std::string &get_errors(void) const {return errors;}
+
+    /**
+        Get symbol table, label to instruction address
+    */
+    const std::unordered_map<std::string, ISA::Address> &get_symbols(void) const {return symbols;}
+
     /**
         Dump parsed machine code to output file.
         for online validation, please go to https://www.eg.bucknell.edu/%7Ecsci320/mips_web/
 
         @param output_filename output filename.    
     */
-    void dump(const std::string &output_filename);
+    void dump(const std::string &output_filename) {dump(text_segment, output_filename);}
+
+    /**
+        Dump machine code of any text segment, e.g. one loaded from a program image.
+
+        @param text text segment.
+        @param output_filename output filename.
+    */
+    static void dump(ISA::TextSegment &text, const std::string &output_filename);
+
+    /**
+        Dump symbol map, one label per line in address order.
+
+        @param output_filename output filename.
+    */
+    void dump_symbols(const std::string &output_filename) {dump_symbols(symbols, output_filename);}
+
+    /**
+        Dump any symbol table, e.g. one loaded from a program image.
+
+        @param symbols symbol table, label to instruction address.
+        @param output_filename output filename.
+    */
+    static void dump_symbols(const std::unordered_map<std::string, ISA::Address> &symbols, const std::string &output_filename);
+
+    /**
+        Dump binary program image with line & symbol tables, loadable without assembly.
+
+        @param output_filename output filename.
+    */
+    void dump_image(const std::string &output_filename);
+
+    /**
+        Fingerprint input ASM for content-addressed caching, FNV-1a over source, assembler version, text address, scheduling & delay slots.
+
+        @param input_filename input ASM filename.
+        @param text_starting_addr address of first instruction.
+        @param schedule whether instructions are scheduled.
+        @param fill_delay_slots whether delay slots are inserted behind branches.
+        @return 16 hex digit fingerprint, empty if input cannot be read.
+    */
+    static std::string fingerprint(
+        const std::string &input_filename, std::uint32_t text_starting_addr = 0x00400000,
+        bool schedule = false, bool fill_delay_slots = false
+    );
+
+    /**
+        Assemble input ASM straight into a binary program image with bounded memory, for inputs too large to retain.
+        Labels are collected by a first streaming pass, then lines are encoded & written block by block.
+        The image carries no source text, which optionally goes to a sidecar line table instead.
+
+        @param input_filename input ASM filename.
+        @param output_filename output program image filename.
+        @param lines_filename sidecar line table filename, "address<TAB>line<TAB>text" per instruction, empty to skip.
+        @param text_starting_addr address of first instruction.
+        @param jobs number of worker threads for normalization & encoding, 0 for one per hardware thread.
+        @return number of instructions.
+    */
+    static std::size_t stream(
+        const std::string &input_filename,
+        const std::string &output_filename,
+        const std::string &lines_filename = "",
+        std::uint32_t text_starting_addr = 0x00400000,
+        std::size_t jobs = 1
+    );
 private:
     struct RTypeField {
         std::uint32_t opcode;
@@ -37,10 +148,36 @@ private:
     struct ITypeField {
         std::uint32_t opcode;
     };
+    struct Operand {
+        enum Kind {
+            // '$' prefixed register name:
+            REGISTER,
+            // hexadecimal immediate:
+            IMMEDIATE,
+            // branch offset, hexadecimal immediate or label:
+            OFFSET
+        };
+
+        ISA::Field field;
+        Kind kind;
+        // characters separating operand from previous token, besides whitespace:
+        const char *separator;
+    };
     struct Decoder {
         ISA::Type type;
-        std::string regex;
-        std::map<std::size_t, ISA::Field> group_name;
+        std::vector<Operand> operands;
+        // characters allowed after last operand, besides whitespace:
+        const char *trailer;
+    };
+    // position of instruction in input ASM:
+    struct SourceLocation {
+        std::size_t line;
+        std::size_t column;
+    };
+    // syntax error report & input ASM line it refers to, for reporting in input order:
+    struct Diagnostic {
+        std::size_t line;
+        std::string message;
     };
 
     /*
@@ -64,27 +201,68 @@ private:
     // 3. decoders:
     static const std::map<std::string, const Decoder&> INSTRUCTION_DECODER;
 
-    std::vector<std::string> instructions;
+    // memory-mapped input ASM, alive until text segment is built:
+    std::unique_ptr<PipelineTrace::MappedFile> source;
+    // slices of mapped input, lines until normalized then instructions:
+    std::vector<std::string_view> instructions;
+    std::vector<SourceLocation> locations;
     std::vector<ISA::MachineCode> machine_codes;
+    // label to instruction address:
+    std::unordered_map<std::string, ISA::Address> symbols;
+    // duplicate labels by input ASM line, reported along with syntax errors of their block:
+    std::vector<Diagnostic> label_diagnostics;
+    // reported errors, kept for callers that cannot watch std::cerr:
+    std::size_t num_errors;
+    std::string errors;
+    // position of loaded lines in input ASM, non-zero for later blocks when streaming:
+    std::size_t first_line;
+    std::size_t first_instruction;
 
     const std::uint32_t TEXT_STARTING_ADDR;
+    const std::size_t JOBS;
     ISA::TextSegment text_segment;
 
+    // lines per block when streaming:
+    static const std::size_t STREAM_BLOCK_LINES = 65536;
+
+    /**
+        Empty assembler, without input.
+
+        @param text_starting_addr address of first instruction.
+        @param jobs number of worker threads for normalization & encoding, 0 for one per hardware thread.
+    */
+    Assembler(std::uint32_t text_starting_addr, std::size_t jobs);
+
     /**
-        Normalize each instruction before parsing.
+        Normalize each instruction before parsing, by narrowing the slice.
 
         @param instruction input instruction.
         @return true for valid instruction otherwise false.
     */
-    bool normalize(std::string &instruction);
+    bool normalize(std::string_view &instruction);
 
     /**
-        Load instructions from input ASM.
+        Map input ASM & split it into raw lines, without copying.
 
         @param input_filename input ASM filename.
     */
     void load(const std::string &input_filename);
 
+    /**
+        Split input into raw lines, without copying.
+
+        @param input input ASM source text.
+    */
+    void split(std::string_view input);
+
+    /**
+        Parse loaded lines, optionally schedule & fill delay slots, then build text segment.
+
+        @param schedule reorder independent instructions inside basic blocks to reduce data hazard stalls.
+        @param fill_delay_slots insert a delay slot behind every branch, filled with an independent instruction where safe.
+    */
+    void assemble(bool schedule, bool fill_delay_slots);
+
     /**
         Set opcode & funct for R-type instruction.
 
@@ -109,16 +287,88 @@ private:
     /**
         Set other fields (rs, rt, rd, shamt & imm) for instruction.
 
-        @param instruction instruction statement.
+        @param index instruction index.
+        @param begin position of first operand separator inside instruction.
         @param decoder instruction decoder.
         @param machine_code output machine code reference.
+        @param log syntax error output.
+        @return true on success, false on syntax error.
+    */
+    bool set_fields(std::size_t index, std::size_t begin, const Decoder& decoder, ISA::MachineCode &machine_code, std::ostream &log);
+
+    /**
+        Report syntax error at instruction position.
+
+        @param index instruction index.
+        @param position position inside normalized instruction.
+        @param message error message.
+        @param log syntax error output.
+        @return false.
+    */
+    bool error(std::size_t index, std::size_t position, const std::string &message, std::ostream &log);
+    static bool error(
+        const SourceLocation &location, std::string_view instruction,
+        std::size_t position, const std::string &message, std::ostream &log
+    );
+
+    /**
+        Strip leading label from normalized instruction and define it.
+
+        @param instruction normalized instruction, label removed in place.
+        @param location instruction position, column moved past label.
+        @param address address of next instruction.
+        @param define false to strip only, for labels already defined.
+        @return true when an instruction follows otherwise false.
+    */
+    bool define_label(std::string_view &instruction, SourceLocation &location, ISA::Address address, bool define = true);
+
+    /**
+        Report duplicate labels & buffered syntax errors up to last line, in input order.
+
+        @param diagnostics syntax errors, one sorted list per chunk.
+        @param last_line last input ASM line covered.
+    */
+    void report(const std::vector<std::vector<Diagnostic>> &diagnostics, std::size_t last_line);
+
+    /**
+        Write error report to std::cerr & keep it.
+
+        @param message error report.
+    */
+    void report_error(const std::string &message);
+
+    /**
+        Encode one normalized instruction.
+
+        @param index instruction index.
+        @param log syntax error output.
+        @return machine code, operation only on syntax error.
+    */
+    ISA::MachineCode encode(std::size_t index, std::ostream &log);
+
+    /**
+        Normalize lines & parse instructions into machine code, in parallel over contiguous chunks of input.
+
+        @param define_labels false when labels were defined by an earlier pass.
+    */
+    void parse(bool define_labels = true);
+
+    /**
+        Get basic block leaders -- labels & branch targets.
+    */
+    std::vector<bool> get_leaders(void) const;
+
+    /**
+        Reorder independent instructions inside basic blocks to separate RAW-dependent pairs,
+        labels & branches staying in place. Reports predicted data hazard stalls.
     */
-    void set_fields(const std::string &instruction, const Decoder& decoder, ISA::MachineCode &machine_code);
+    void schedule(void);
 
     /**
-        Parse instructions into machine code.
+        Insert a delay slot behind every branch, filled with an instruction moved down from above the branch
+        or a nop. Labels & branch offsets are relocated. Reports filled slots.
     */
-    void parse(void);
+    void fill_delay_slots(void);
 
     /**
         Build instruction memory image.
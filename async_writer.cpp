@@ -0,0 +1,77 @@
+#include "async_writer.h"
+
+AsyncWriter::AsyncWriter(std::FILE *output, std::size_t buffer_size): BUFFER_SIZE(buffer_size), output(output), pending(false), stopped(false) {
+    front.reserve(BUFFER_SIZE + (BUFFER_SIZE >> 2));
+    back.reserve(BUFFER_SIZE + (BUFFER_SIZE >> 2));
+
+    worker = std::thread(&AsyncWriter::drain, this);
+}
+
+AsyncWriter::~AsyncWriter() {
+    close();
+}
+
+/**
+    Write out all pending bytes & stop writer thread.
+*/
+void AsyncWriter::close(void) {
+    if (!worker.joinable()) {
+        return;
+    }
+
+    submit();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    cond.notify_all();
+    worker.join();
+
+    if (stdout == output) {
+        std::fflush(output);
+    } else {
+        std::fclose(output);
+    }
+}
+
+/**
+    Hand filled front buffer to writer thread, waiting for the previous one to drain.
+*/
+void AsyncWriter::submit(void) {
+    if (front.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this]() {return !pending;});
+
+    front.swap(back);
+    pending = true;
+
+    lock.unlock();
+    cond.notify_all();
+}
+
+/**
+    Writer thread main loop.
+*/
+void AsyncWriter::drain(void) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        cond.wait(lock, [this]() {return pending || stopped;});
+
+        if (pending) {
+            // write without holding the lock so that the producer keeps filling front:
+            lock.unlock();
+            std::fwrite(back.data(), 1, back.size(), output);
+            back.clear();
+            lock.lock();
+
+            pending = false;
+            cond.notify_all();
+        } else if (stopped) {
+            return;
+        }
+    }
+}
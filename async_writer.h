@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ *  Double-buffered output stream drained by a background writer thread.
+ *  The producer only appends to memory; no flush happens until a buffer fills up or close().
+ */
+class AsyncWriter {
+public:
+    /**
+        @param output output stream, owned & closed by writer unless it is stdout.
+        @param buffer_size bytes accumulated before handing a buffer to the writer thread.
+    */
+    AsyncWriter(std::FILE *output, std::size_t buffer_size = (1 << 20));
+    ~AsyncWriter();
+
+    /**
+        Append bytes to output.
+
+        @param data bytes to write.
+        @param size number of bytes.
+    */
+    void write(const char *data, std::size_t size) {
+        front.append(data, size);
+
+        if (BUFFER_SIZE <= front.size()) {
+            submit();
+        }
+    }
+    void write(const std::string &data) {
+        write(data.data(), data.size());
+    }
+
+    /**
+        Write out all pending bytes & stop writer thread.
+    */
+    void close(void);
+private:
+    const std::size_t BUFFER_SIZE;
+    std::FILE *output;
+
+    // filled by producer:
+    std::string front;
+    // drained by writer thread:
+    std::string back;
+    bool pending;
+    bool stopped;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::thread worker;
+
+    void submit(void);
+    void drain(void);
+};
@@ -0,0 +1,764 @@
+/**
+    bench.cpp
+    Purpose: Microbenchmarks of assembler, text & data segments, pipeline stages and end-to-end simulation
+
+    @version 1.0
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <cstdio>
+#include <unistd.h>
+
+#include <boost/program_options.hpp>
+
+#include "json.h"
+#include "isa.h"
+#include "assembler.h"
+#include "executor.h"
+#include "decoupled.h"
+#include "pipeline_trace.h"
+
+namespace po = boost::program_options;
+
+namespace {
+    /*
+        canonical kernels, endless loops bounded by instruction budget.
+        Branch operands are produced well ahead of the branch, see data hazard handling in Executor::execute_ID
+     */
+    struct Kernel {
+        const char *name;
+        const char *source;
+    };
+    const Kernel KERNELS[] = {
+        {
+            "independent",
+            "loop: addi $t0 $zero 0x0001\n"
+            "addi $t1 $zero 0x0002\n"
+            "add $t2 $s0 $s1\n"
+            "sub $t3 $s2 $s3\n"
+            "lw $t4 0x0010 $zero\n"
+            "sw $t5 0x0020 $zero\n"
+            "sll $t6 $s0 0x2\n"
+            "ori $t7 $s1 0x00ff\n"
+            "beq $zero $zero loop\n"
+            "add $t8 $t8 $t8\n"
+        },
+        {
+            "dependent",
+            "loop: addi $t0 $t0 0x0001\n"
+            "addi $t0 $t0 0x0001\n"
+            "addi $t0 $t0 0x0001\n"
+            "addi $t0 $t0 0x0001\n"
+            "beq $zero $zero loop\n"
+            "add $t8 $t8 $t8\n"
+        },
+        {
+            "memory",
+            "loop: lui $t1 0x0010\n"
+            "addi $t0 $t0 0x0001\n"
+            "sll $t3 $t0 0x2\n"
+            "lw $t2 0x0000 $t3\n"
+            "sw $t2 0x0040 $zero\n"
+            "beq $t0 $t1 done\n"
+            "beq $zero $zero loop\n"
+            "done: add $t8 $t8 $t8\n"
+        },
+        {
+            "multiply",
+            "loop: lui $t8 0x0003\n"
+            "lui $t9 0x0005\n"
+            "mul $t0 $t8 $t9\n"
+            "mul $t2 $t8 $t9\n"
+            "mult $t8 $t9\n"
+            "beq $zero $zero loop\n"
+            "add $t7 $t7 $t7\n"
+        },
+        {
+            "branch",
+            "loop: addi $t0 $t0 0x0001\n"
+            "andi $t1 $t0 0x0001\n"
+            "addi $t2 $t2 0x0001\n"
+            "addi $t3 $t3 0x0001\n"
+            "beq $t1 $zero skip\n"
+            "addi $t4 $t4 0x0001\n"
+            "skip: beq $zero $zero loop\n"
+            "add $t8 $t8 $t8\n"
+        }
+    };
+    // kernel used to warm up pipeline latches for stage benchmarks:
+    const std::size_t STAGE_KERNEL = 0;
+    // kernel rerun on new data memory for rerun benchmarks:
+    const std::size_t RERUN_KERNEL = 2;
+
+    /*
+        workload sizes
+     */
+    const std::size_t ASSEMBLER_LINES = 100000;
+    const std::size_t TEXT_SEGMENT_SIZE = 4096;
+    const std::size_t TEXT_SEGMENT_PASSES = 64;
+    const std::size_t DATA_SEGMENT_SIZE = 1 << 16;
+    const std::size_t DATA_SEGMENT_PASSES = 16;
+    const std::size_t STAGE_CALLS = 1 << 20;
+    const std::size_t DISASSEMBLER_SAMPLES = 64;
+    const std::size_t DISASSEMBLER_PASSES = 64;
+    const int KERNEL_INSTRUCTIONS = 200000;
+    const std::size_t RERUN_RUNS = 4096;
+    const int RERUN_INSTRUCTIONS = 64;
+    // input words per rerun, read by the memory kernel:
+    const std::size_t RERUN_WORDS = 64;
+
+    /**
+        Best wall-clock seconds of repeated runs.
+
+        @param repeat number of runs.
+        @param function benchmarked function.
+    */
+    double measure(std::size_t repeat, const std::function<void(void)> &function) {
+        double best = std::numeric_limits<double>::max();
+
+        for (std::size_t i = 0; i < repeat; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            best = std::min(best, elapsed.count());
+        }
+
+        return best;
+    }
+
+    /**
+     *  Temporary ASM file, removed on destruction.
+     */
+    class TemporaryFile {
+    public:
+        TemporaryFile(const std::string &content) {
+            char name[] = "/tmp/mips-bench-XXXXXX";
+            const int fd = mkstemp(name);
+            if (-1 == fd) {
+                throw std::runtime_error("cannot create temporary file");
+            }
+            close(fd);
+
+            filename = name;
+            std::ofstream output(filename);
+            output << content;
+        }
+        ~TemporaryFile() {
+            std::remove(filename.c_str());
+        }
+
+        const std::string &get_filename(void) const {return filename;}
+    private:
+        std::string filename;
+    };
+
+    /**
+        Assemble source, keeping assembler log off the benchmark output.
+
+        @param source MIPS ASM source.
+    */
+    ISA::TextSegment assemble(const std::string &source) {
+        TemporaryFile input(source);
+
+        std::ostringstream log;
+        std::streambuf *const stdout_buffer = std::cout.rdbuf(log.rdbuf());
+        Assembler assembler(input.get_filename());
+        std::cout.rdbuf(stdout_buffer);
+
+        return assembler.get_text_segment();
+    }
+
+    /**
+        Generate large ASM source covering all instruction formats.
+
+        @param lines number of instructions.
+    */
+    std::string generate_source(std::size_t lines) {
+        static const char *TEMPLATES[] = {
+            "add $t2 $s0 $s1",
+            "sub $t3, $s2, $s3",
+            "mul $t0 $t8 $t9",
+            "mult $t8 $t9",
+            "sll $t6 $s0 0x2",
+            "addi $t0 $t0 0x0001",
+            "ori $t7 $s1 0x00ff",
+            "beq $t0 $t1 0x0001",
+            "lui $t1 0x0010",
+            "lw $t2 0x0000($t3)",
+            "sw $t2 0x0040 $zero"
+        };
+        const std::size_t NUM_TEMPLATES = sizeof(TEMPLATES) / sizeof(TEMPLATES[0]);
+
+        std::string source;
+        for (std::size_t i = 0; i < lines; ++i) {
+            source += TEMPLATES[i % NUM_TEMPLATES];
+            source += "\n";
+        }
+
+        return source;
+    }
+}
+
+/**
+ *  Drive Executor stage functions directly on a warmed-up pipeline.
+ */
+class ExecutorBench {
+public:
+    enum Stage {
+        IF = 0,
+        ID = 1,
+        EX = 2,
+        MEM = 3,
+        WB = 4,
+        NUM_STAGES = 5
+    };
+
+    /**
+        @param executor executor of a loaded kernel.
+        @param cycles number of warm-up clock cycles.
+    */
+    static void warm_up(Executor &executor, std::size_t cycles) {
+        executor.init();
+        executor.PC = executor.text_segment.get_address_first();
+
+        for (std::size_t i = 0; i < cycles; ++i) {
+            executor.execute_pipeline();
+        }
+    }
+
+    /**
+        Call one stage function repeatedly on the same latch contents.
+
+        @param executor warmed-up executor, modified.
+        @param stage pipeline stage.
+        @param calls number of calls.
+    */
+    static void run_stage(Executor &executor, Stage stage, std::size_t calls) {
+        const ISA::Address PC = executor.PC;
+
+        for (std::size_t i = 0; i < calls; ++i) {
+            executor.hazard.reset();
+
+            switch (stage) {
+                case IF:
+                    executor.PC = PC;
+                    executor.execute_IF();
+                    break;
+                case ID:
+                    executor.execute_ID();
+                    break;
+                case EX:
+                    executor.execute_EX();
+                    break;
+                case MEM:
+                    executor.execute_MEM();
+                    break;
+                case WB:
+                    executor.execute_WB();
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+};
+
+/**
+ *  Benchmark runner -- collects results, optionally compares them against a saved baseline.
+ */
+class Bench {
+public:
+    Bench(std::size_t repeat, const std::string &filter): REPEAT(repeat), FILTER(filter) {}
+
+    /**
+        Run all benchmarks matching filter.
+    */
+    void run(void) {
+        bench_assembler();
+        bench_text_segment();
+        bench_render();
+        bench_disassembler();
+        bench_data_segment();
+        bench_stages();
+        bench_kernels();
+        bench_rerun();
+    }
+
+    /**
+        Dump results as JSON.
+
+        @param output_filename output filename.
+    */
+    void dump(const std::string &output_filename) {
+        std::ofstream output(output_filename);
+
+        if (!output) {
+            throw std::runtime_error("cannot open output benchmark file " + output_filename);
+        }
+
+        nlohmann::json report;
+        report["configuration"]["repeat"] = REPEAT;
+        report["benchmarks"] = results;
+
+        output << std::setw(4) << report << std::endl;
+    }
+
+    /**
+        Compare results against saved baseline, higher is better for all benchmarks.
+
+        @param baseline_filename baseline JSON filename.
+        @param tolerance relative slowdown tolerated before reporting regression.
+        @return number of regressions.
+    */
+    std::size_t compare(const std::string &baseline_filename, double tolerance) {
+        std::ifstream input(baseline_filename);
+
+        if (!input) {
+            throw std::runtime_error("cannot open baseline benchmark file " + baseline_filename);
+        }
+
+        nlohmann::json baseline;
+        try {
+            input >> baseline;
+        } catch (const std::exception &e) {
+            throw std::runtime_error("invalid baseline benchmark file " + baseline_filename + " -- " + e.what());
+        }
+
+        std::size_t regressions = 0;
+        for (auto it = results.begin(); it != results.end(); ++it) {
+            if (!baseline["benchmarks"].count(it.key())) {
+                continue;
+            }
+
+            const double previous = baseline["benchmarks"][it.key()]["value"];
+            const double current = it.value()["value"];
+            const double change = (0.0 == previous) ? 0.0 : current / previous - 1.0;
+            const bool regression = change < -tolerance;
+
+            std::cout << "[MIPS simulator]: bench -- " << std::setfill(' ') << std::left << std::setw(32) << it.key() << std::right
+                      << std::showpos << std::fixed << std::setprecision(1) << std::setw(8) << 100.0 * change << "%"
+                      << std::noshowpos << (regression ? "  REGRESSION" : "") << std::endl;
+
+            regressions += regression ? 1 : 0;
+        }
+
+        return regressions;
+    }
+private:
+    const std::size_t REPEAT;
+    const std::string FILTER;
+
+    nlohmann::json results;
+
+    bool is_selected(const std::string &name) const {
+        return std::string::npos != name.find(FILTER);
+    }
+
+    void record(const std::string &name, double value, const std::string &unit) {
+        results[name] = {{"value", value}, {"unit", unit}};
+
+        std::cout << "[MIPS simulator]: bench -- " << std::setfill(' ') << std::left << std::setw(32) << name << std::right
+                  << std::fixed << std::setprecision(0) << std::setw(16) << value << " " << unit << std::endl;
+    }
+
+    // a. assembler throughput, serial & one thread per hardware thread:
+    void bench_assembler(void) {
+        const std::string SERIAL = "assembler";
+        const std::string PARALLEL = "assembler (parallel)";
+        if (!is_selected(SERIAL) && !is_selected(PARALLEL)) {
+            return;
+        }
+
+        TemporaryFile input(generate_source(ASSEMBLER_LINES));
+
+        for (std::size_t jobs: {1, 0}) {
+            const std::string NAME = (1 == jobs) ? SERIAL : PARALLEL;
+            if (!is_selected(NAME)) {
+                continue;
+            }
+
+            const double seconds = measure(
+                REPEAT,
+                [&input, jobs]() {
+                    std::ostringstream log;
+                    std::streambuf *const stdout_buffer = std::cout.rdbuf(log.rdbuf());
+                    Assembler assembler(input.get_filename(), 0x00400000, jobs);
+                    std::cout.rdbuf(stdout_buffer);
+                }
+            );
+
+            record(NAME, ASSEMBLER_LINES / seconds, "lines/s");
+        }
+    }
+
+    // b. text segment fetch:
+    void bench_text_segment(void) {
+        const std::string NAME = "text segment fetch";
+        if (!is_selected(NAME)) {
+            return;
+        }
+
+        const ISA::Address BEGIN = 0x00400000;
+        ISA::TextSegment text_segment;
+        for (std::size_t i = 0; i < TEXT_SEGMENT_SIZE; ++i) {
+            text_segment.set(BEGIN + (i << 2), static_cast<ISA::MachineCode>(i), "nop");
+        }
+
+        volatile std::uint32_t sink = 0;
+        const double seconds = measure(
+            REPEAT,
+            [&text_segment, &sink, BEGIN]() {
+                std::uint32_t checksum = 0;
+                for (std::size_t pass = 0; pass < TEXT_SEGMENT_PASSES; ++pass) {
+                    for (std::size_t i = 0; i < TEXT_SEGMENT_SIZE; ++i) {
+                        checksum += text_segment.get_binary(BEGIN + (i << 2));
+                    }
+                }
+                sink = checksum;
+            }
+        );
+
+        record(NAME, (TEXT_SEGMENT_PASSES * TEXT_SEGMENT_SIZE) / seconds, "fetches/s");
+    }
+
+    // system state plot rendering of one snapshot per clock cycle:
+    void bench_render(void) {
+        const std::string NAME = "system state plot render";
+        if (!is_selected(NAME)) {
+            return;
+        }
+
+        const ISA::Address BEGIN = 0x00400000;
+        ISA::TextSegment text_segment;
+        for (std::size_t i = 0; i < TEXT_SEGMENT_SIZE; ++i) {
+            text_segment.set(BEGIN + (i << 2), static_cast<ISA::MachineCode>(i), "addi $t0 $t1 0x0001");
+        }
+
+        volatile std::size_t sink = 0;
+        std::string line;
+        const double seconds = measure(
+            REPEAT,
+            [&text_segment, &sink, &line, BEGIN]() {
+                std::size_t size = 0;
+                PipelineSnapshot snapshot = {};
+                for (std::size_t pass = 0; pass < TEXT_SEGMENT_PASSES; ++pass) {
+                    for (std::size_t i = 0; i < TEXT_SEGMENT_SIZE; ++i) {
+                        snapshot.cycle = i;
+                        for (std::size_t stage = 0; stage < PipelineTrace::NUM_STAGES; ++stage) {
+                            snapshot.pc[stage] = BEGIN + (((i + TEXT_SEGMENT_SIZE - stage) % TEXT_SEGMENT_SIZE) << 2);
+                        }
+
+                        line.clear();
+                        PipelineTrace::render(line, snapshot, text_segment);
+                        size += line.size();
+                    }
+                }
+                sink = size;
+            }
+        );
+
+        record(NAME, (TEXT_SEGMENT_PASSES * TEXT_SEGMENT_SIZE) / seconds, "snapshots/s");
+    }
+
+    // disassembler throughput, after checking every assembled format disassembles back to the same machine code:
+    void bench_disassembler(void) {
+        const std::string NAME = "disassembler";
+        if (!is_selected(NAME)) {
+            return;
+        }
+
+        // a. machine codes of every opcode & funct with pseudo-random fields, kept when disassembled to an instruction:
+        std::vector<ISA::MachineCode> machine_codes;
+        std::string source;
+        char text[ISA::DISASSEMBLY_SIZE];
+        std::uint32_t state = 0x2545F491;
+        for (ISA::Word opcode = 0; opcode < 64; ++opcode) {
+            for (ISA::Word funct = 0; funct < ((ISA::OpCode::R_COMMON == opcode) ? 64 : 1); ++funct) {
+                for (std::size_t i = 0; i < DISASSEMBLER_SAMPLES; ++i) {
+                    state ^= state << 13;
+                    state ^= state >> 17;
+                    state ^= state << 5;
+
+                    ISA::MachineCode machine_code = state & 0x03FFFFFF;
+                    ISA::set_instruction_field(machine_code, ISA::Field::OPCODE, opcode);
+                    if (ISA::OpCode::R_COMMON == opcode) {
+                        machine_code = (machine_code & ~0x0000003Fu) | funct;
+                    }
+                    // clear fields unused by format, sampled half of the time:
+                    if (0 == (i & 1)) {
+                        machine_code &= (ISA::OpCode::R_COMMON == opcode) ? ((ISA::Funct::SLL == funct || ISA::Funct::SRL == funct) ? ~0x03E00000u : ~0x000007C0u) : ~0u;
+                        machine_code &= (ISA::Funct::MULT == funct && ISA::OpCode::R_COMMON == opcode) ? ~0x0000F800u : ~0u;
+                        machine_code &= (ISA::OpCode::LUI == opcode) ? ~0x03E00000u : ~0u;
+                    }
+
+                    const std::size_t size = ISA::disassemble(machine_code, text);
+                    if ('.' != text[0]) {
+                        machine_codes.push_back(machine_code);
+                        source.append(text, size);
+                        source += "\n";
+                    }
+                }
+            }
+        }
+
+        // b. round trip through the assembler:
+        ISA::TextSegment text_segment = assemble(source);
+        for (std::size_t i = 0; i < machine_codes.size(); ++i) {
+            const ISA::MachineCode machine_code = text_segment.get_binary(0x00400000 + (i << 2));
+            if (machine_codes[i] != machine_code) {
+                std::ostringstream message;
+                message << "disassembler round trip mismatch -- 0x" << std::hex << std::setfill('0') << std::setw(8) << machine_codes[i]
+                        << " disassembled to '" << text_segment.get_text(0x00400000 + (i << 2)) << "', assembled to 0x" << std::setw(8) << machine_code;
+                throw std::runtime_error(message.str());
+            }
+        }
+
+        // c. throughput:
+        volatile std::size_t sink = 0;
+        const double seconds = measure(
+            REPEAT,
+            [&machine_codes, &sink]() {
+                char text[ISA::DISASSEMBLY_SIZE];
+                std::size_t size = 0;
+                for (std::size_t pass = 0; pass < DISASSEMBLER_PASSES; ++pass) {
+                    for (const auto machine_code: machine_codes) {
+                        size += ISA::disassemble(machine_code, text);
+                    }
+                }
+                sink = size;
+            }
+        );
+
+        record(NAME, (DISASSEMBLER_PASSES * machine_codes.size()) / seconds, "instructions/s");
+    }
+
+    // c. data segment load & store:
+    void bench_data_segment(void) {
+        const std::string LOAD = "data segment load";
+        const std::string STORE = "data segment store";
+
+        if (is_selected(STORE)) {
+            const double seconds = measure(
+                REPEAT,
+                []() {
+                    ISA::DataSegment data_segment(0x00000000);
+                    for (std::size_t i = 0; i < DATA_SEGMENT_SIZE; ++i) {
+                        data_segment.set(i << 2, i);
+                    }
+                }
+            );
+
+            record(STORE, DATA_SEGMENT_SIZE / seconds, "stores/s");
+        }
+
+        if (is_selected(LOAD)) {
+            ISA::DataSegment data_segment(0x00000000);
+            for (std::size_t i = 0; i < DATA_SEGMENT_SIZE; ++i) {
+                data_segment.set(i << 2, i);
+            }
+
+            volatile ISA::Word sink = 0;
+            const double seconds = measure(
+                REPEAT,
+                [&data_segment, &sink]() {
+                    ISA::Word checksum = 0;
+                    for (std::size_t pass = 0; pass < DATA_SEGMENT_PASSES; ++pass) {
+                        for (std::size_t i = 0; i < DATA_SEGMENT_SIZE; ++i) {
+                            checksum += data_segment.get(i << 2);
+                        }
+                    }
+                    sink = checksum;
+                }
+            );
+
+            record(LOAD, (DATA_SEGMENT_PASSES * DATA_SEGMENT_SIZE) / seconds, "loads/s");
+        }
+    }
+
+    // d. stage functions on a warmed-up pipeline:
+    void bench_stages(void) {
+        static const char *STAGE_NAME[ExecutorBench::NUM_STAGES] = {
+            "execute_IF", "execute_ID", "execute_EX", "execute_MEM", "execute_WB"
+        };
+
+        ISA::TextSegment text_segment = assemble(KERNELS[STAGE_KERNEL].source);
+
+        for (std::size_t stage = 0; stage < ExecutorBench::NUM_STAGES; ++stage) {
+            const std::string NAME = STAGE_NAME[stage];
+            if (!is_selected(NAME)) {
+                continue;
+            }
+
+            const double seconds = measure(
+                REPEAT,
+                [&text_segment, stage]() {
+                    ISA::DataSegment data_segment(0x00000000);
+                    Executor executor(text_segment, data_segment);
+
+                    ExecutorBench::warm_up(executor, ExecutorBench::NUM_STAGES + 1);
+                    ExecutorBench::run_stage(executor, static_cast<ExecutorBench::Stage>(stage), STAGE_CALLS);
+                }
+            );
+
+            record(NAME, STAGE_CALLS / seconds, "calls/s");
+        }
+    }
+
+    // e. end-to-end simulation of canonical kernels:
+    void bench_kernels(void) {
+        for (const Kernel &kernel: KERNELS) {
+            const std::string PIPELINE = std::string("kernel ") + kernel.name + " (pipeline)";
+            const std::string DECOUPLED = std::string("kernel ") + kernel.name + " (decoupled)";
+            if (!is_selected(PIPELINE) && !is_selected(DECOUPLED)) {
+                continue;
+            }
+
+            ISA::TextSegment text_segment = assemble(kernel.source);
+
+            if (is_selected(PIPELINE)) {
+                std::int32_t instructions = 0;
+                const double seconds = measure(
+                    REPEAT,
+                    [&text_segment, &instructions]() {
+                        ISA::DataSegment data_segment(0x00000000);
+                        Executor executor(text_segment, data_segment);
+                        executor.run("instruction", KERNEL_INSTRUCTIONS);
+                        instructions = executor.get_total_instructions();
+                    }
+                );
+
+                record(PIPELINE, instructions / seconds, "instructions/s");
+            }
+
+            if (is_selected(DECOUPLED)) {
+                std::int32_t instructions = 0;
+                const double seconds = measure(
+                    REPEAT,
+                    [&text_segment, &instructions]() {
+                        ISA::DataSegment data_segment(0x00000000);
+                        DecoupledSimulator simulator(text_segment, data_segment);
+                        simulator.run("instruction", KERNEL_INSTRUCTIONS);
+                        instructions = simulator.get_total_instructions();
+                    }
+                );
+
+                record(DECOUPLED, instructions / seconds, "instructions/s");
+            }
+        }
+    }
+
+    // f. short reruns of one kernel on new data memory, constructing vs. resetting the executor:
+    void bench_rerun(void) {
+        const std::string CONSTRUCT = "executor rerun (construct)";
+        const std::string RESET = "executor rerun (reset)";
+
+        ISA::TextSegment text_segment = assemble(KERNELS[RERUN_KERNEL].source);
+
+        if (is_selected(CONSTRUCT)) {
+            const double seconds = measure(
+                REPEAT,
+                [&text_segment]() {
+                    for (std::size_t run = 0; run < RERUN_RUNS; ++run) {
+                        ISA::DataSegment data_segment(0x00000000);
+                        for (std::size_t i = 0; i < RERUN_WORDS; ++i) {
+                            data_segment.set(ISA::Address(i << 2), run + i);
+                        }
+
+                        Executor executor(text_segment, data_segment);
+                        executor.run("instruction", RERUN_INSTRUCTIONS);
+                    }
+                }
+            );
+
+            record(CONSTRUCT, RERUN_RUNS / seconds, "runs/s");
+        }
+
+        if (is_selected(RESET)) {
+            const double seconds = measure(
+                REPEAT,
+                [&text_segment]() {
+                    ISA::DataSegment data_segment(0x00000000);
+                    Executor executor(text_segment, data_segment);
+
+                    for (std::size_t run = 0; run < RERUN_RUNS; ++run) {
+                        data_segment.clear();
+                        for (std::size_t i = 0; i < RERUN_WORDS; ++i) {
+                            data_segment.set(ISA::Address(i << 2), run + i);
+                        }
+
+                        executor.reset(data_segment);
+                        executor.run("instruction", RERUN_INSTRUCTIONS);
+                    }
+                }
+            );
+
+            record(RESET, RERUN_RUNS / seconds, "runs/s");
+        }
+    }
+};
+
+int main(int argc, char* argv[]) {
+    std::string output_filename, baseline_filename, filter;
+    std::size_t repeat;
+    double tolerance;
+
+    try {
+        // set parser:
+        po::options_description desc("MIPS simulator microbenchmarks usage");
+        desc.add_options()
+          ("help",      "produce help message")
+          ("output",    po::value<std::string>(&output_filename)->default_value("../output/bench.json"), "set output JSON results file")
+          ("baseline",  po::value<std::string>(&baseline_filename),                   "set saved JSON results to compare against")
+          ("tolerance", po::value<double>(&tolerance)->default_value(0.05),          "set relative slowdown tolerated before reporting regression")
+          ("repeat",    po::value<std::size_t>(&repeat)->default_value(3),           "set number of runs per benchmark, best run is kept")
+          ("filter",    po::value<std::string>(&filter)->default_value(""),          "run only benchmarks whose name contains filter")
+        ;
+
+        // parse arguments:
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << "\n";
+            return 0;
+        }
+        po::notify(vm);
+
+        if (0 == repeat) {
+            throw std::runtime_error("repeat must be positive");
+        }
+    }
+    catch(std::exception& e) {
+        std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << "\n";
+        return 1;
+    }
+
+    std::size_t regressions = 0;
+    try {
+        Bench bench(repeat, filter);
+
+        bench.run();
+        bench.dump(output_filename);
+
+        if (!baseline_filename.empty()) {
+            regressions = bench.compare(baseline_filename, tolerance);
+        }
+    }
+    catch(std::runtime_error& e) {
+        std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << "\n";
+        return 1;
+    }
+
+    // non-zero exit status on regression, for use in scripts:
+    return (0 == regressions) ? 0 : 2;
+}
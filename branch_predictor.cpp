@@ -0,0 +1,115 @@
+#include "branch_predictor.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+BranchPredictor::BranchPredictor(Policy policy, std::size_t entries): POLICY(policy), MASK(0) {
+    validate(policy, entries);
+
+    if (BIMODAL == POLICY) {
+        MASK = entries - 1;
+        counters.resize(entries);
+    }
+
+    reset();
+}
+
+/**
+    Check predictor configuration, throws std::runtime_error if invalid.
+
+    @param policy prediction policy.
+    @param entries number of counters for BIMODAL, power of two.
+*/
+void BranchPredictor::validate(Policy policy, std::size_t entries) {
+    if (BIMODAL == policy && (0 == entries || 0 != (entries & (entries - 1)))) {
+        throw std::runtime_error("invalid predictor entries -- must be a power of two");
+    }
+}
+
+/**
+    Parse policy name.
+
+    @param name one of stall, not-taken, taken, bimodal.
+*/
+BranchPredictor::Policy BranchPredictor::parse_policy(const std::string &name) {
+    if ("stall" == name) {
+        return STALL;
+    } else if ("not-taken" == name) {
+        return NOT_TAKEN;
+    } else if ("taken" == name) {
+        return TAKEN;
+    } else if ("bimodal" == name) {
+        return BIMODAL;
+    }
+
+    throw std::runtime_error("invalid branch policy -- (stall, not-taken, taken or bimodal ONLY)");
+}
+
+std::string BranchPredictor::get_policy_name(Policy policy) {
+    switch (policy) {
+        case NOT_TAKEN:
+            return "not-taken";
+        case TAKEN:
+            return "taken";
+        case BIMODAL:
+            return "bimodal";
+        case STALL:
+        default:
+            return "stall";
+    }
+}
+
+/**
+    Predict branch & train predictor with its actual outcome.
+
+    @param pc branch address.
+    @param taken actual branch outcome.
+    @return true if the branch is correctly predicted.
+*/
+bool BranchPredictor::predict(ISA::Address pc, bool taken) {
+    bool prediction = false;
+    bool correct = false;
+
+    switch (POLICY) {
+        case NOT_TAKEN:
+            correct = !taken;
+            break;
+        case TAKEN:
+            correct = taken;
+            break;
+        case BIMODAL: {
+            std::uint8_t &counter = counters[(pc >> 2) & MASK];
+
+            prediction = (2 <= counter);
+            correct = (prediction == taken);
+
+            // train:
+            if (taken && 3 > counter) {
+                ++counter;
+            } else if (!taken && 0 < counter) {
+                --counter;
+            }
+            break;
+        }
+        case STALL:
+        default:
+            break;
+    }
+
+    ++branches;
+    if (!correct) {
+        ++mispredictions;
+    }
+
+    return correct;
+}
+
+/**
+    Reset counters & statistics.
+*/
+void BranchPredictor::reset(void) {
+    // weakly not-taken:
+    std::fill(counters.begin(), counters.end(), 1);
+
+    branches = mispredictions = 0;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "isa.h"
+
+/**
+ *  Branch direction predictor.
+ */
+class BranchPredictor {
+public:
+    enum Policy {
+        // no prediction, stall until branch resolves:
+        STALL,
+        // static predictions:
+        NOT_TAKEN,
+        TAKEN,
+        // table of 2-bit saturating counters indexed by PC:
+        BIMODAL
+    };
+
+    /**
+        @param policy prediction policy.
+        @param entries number of counters for BIMODAL, power of two.
+    */
+    BranchPredictor(Policy policy = STALL, std::size_t entries = 64);
+
+    /**
+        Check predictor configuration, throws std::runtime_error if invalid.
+
+        @param policy prediction policy.
+        @param entries number of counters for BIMODAL, power of two.
+    */
+    static void validate(Policy policy, std::size_t entries);
+
+    /**
+        Parse policy name.
+
+        @param name one of stall, not-taken, taken, bimodal.
+    */
+    static Policy parse_policy(const std::string &name);
+    static std::string get_policy_name(Policy policy);
+
+    /**
+        Predict branch & train predictor with its actual outcome.
+
+        @param pc branch address.
+        @param taken actual branch outcome.
+        @return true if the branch is correctly predicted.
+    */
+    bool predict(ISA::Address pc, bool taken);
+
+    /**
+        Reset counters & statistics.
+    */
+    void reset(void);
+
+    Policy get_policy(void) const {return POLICY;}
+    std::uint64_t get_branches(void) const {return branches;}
+    std::uint64_t get_mispredictions(void) const {return mispredictions;}
+private:
+    Policy POLICY;
+    std::size_t MASK;
+    std::vector<std::uint8_t> counters;
+
+    std::uint64_t branches;
+    std::uint64_t mispredictions;
+};
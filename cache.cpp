@@ -0,0 +1,95 @@
+#include "cache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+Cache::Cache(std::size_t size, std::size_t line_size, std::size_t ways): NUM_SETS(0), NUM_WAYS(ways), LINE_SHIFT(0), SET_MASK(0) {
+    validate(size, line_size, ways);
+
+    if (0 == size) {
+        reset();
+        return;
+    }
+
+    while ((static_cast<std::size_t>(1) << LINE_SHIFT) < line_size) {
+        ++LINE_SHIFT;
+    }
+    NUM_SETS = size / (line_size * ways);
+    if (0 == (NUM_SETS & (NUM_SETS - 1))) {
+        SET_MASK = NUM_SETS - 1;
+    }
+
+    tags.resize(NUM_SETS * NUM_WAYS);
+    valid.resize(NUM_SETS * NUM_WAYS);
+    last_used.resize(NUM_SETS * NUM_WAYS);
+
+    reset();
+}
+
+/**
+    Check cache geometry, throws std::runtime_error if invalid.
+
+    @param size total capacity in bytes, 0 for perfect memory.
+    @param line_size line size in bytes, power of two.
+    @param ways associativity.
+*/
+void Cache::validate(std::size_t size, std::size_t line_size, std::size_t ways) {
+    if (0 == size) {
+        return;
+    }
+
+    if (0 == line_size || 0 != (line_size & (line_size - 1)) || 0 == ways || 0 != size % (line_size * ways)) {
+        throw std::runtime_error("invalid cache geometry -- size must be a multiple of line size * ways, line size a power of two");
+    }
+}
+
+/**
+    Access one address.
+
+    @param address byte address.
+    @return true on hit.
+*/
+bool Cache::access(ISA::Address address) {
+    ++accesses;
+
+    // perfect memory:
+    if (!is_enabled()) {
+        return true;
+    }
+
+    const ISA::Address line = address >> LINE_SHIFT;
+    const std::size_t set = (SET_MASK + 1 == NUM_SETS) ? (line & SET_MASK) : (line % NUM_SETS);
+    const std::size_t base = set * NUM_WAYS;
+
+    // a. lookup:
+    std::size_t victim = base;
+    for (std::size_t i = base; i < base + NUM_WAYS; ++i) {
+        if (valid[i] && line == tags[i]) {
+            last_used[i] = accesses;
+            return true;
+        }
+
+        // prefer invalid lines, then least recently used:
+        if (valid[victim] && (!valid[i] || last_used[i] < last_used[victim])) {
+            victim = i;
+        }
+    }
+
+    // b. allocate on miss:
+    ++misses;
+    tags[victim] = line;
+    valid[victim] = 1;
+    last_used[victim] = accesses;
+
+    return false;
+}
+
+/**
+    Invalidate all lines & reset statistics.
+*/
+void Cache::reset(void) {
+    std::fill(valid.begin(), valid.end(), 0);
+    std::fill(last_used.begin(), last_used.end(), 0);
+
+    accesses = misses = 0;
+}
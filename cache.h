@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+#include "isa.h"
+
+/**
+ *  Set-associative cache model with LRU replacement & write-allocate.
+ *  Tracks tags only, data always comes from DataSegment.
+ */
+class Cache {
+public:
+    /**
+        @param size total capacity in bytes, 0 for perfect memory.
+        @param line_size line size in bytes, power of two.
+        @param ways associativity.
+    */
+    Cache(std::size_t size = 0, std::size_t line_size = 16, std::size_t ways = 1);
+
+    /**
+        Check cache geometry, throws std::runtime_error if invalid.
+
+        @param size total capacity in bytes, 0 for perfect memory.
+        @param line_size line size in bytes, power of two.
+        @param ways associativity.
+    */
+    static void validate(std::size_t size, std::size_t line_size, std::size_t ways);
+
+    /**
+        Access one address.
+
+        @param address byte address.
+        @return true on hit.
+    */
+    bool access(ISA::Address address);
+
+    /**
+        Invalidate all lines & reset statistics.
+    */
+    void reset(void);
+
+    bool is_enabled(void) const {return 0 != NUM_SETS;}
+    std::uint64_t get_accesses(void) const {return accesses;}
+    std::uint64_t get_misses(void) const {return misses;}
+private:
+    std::size_t NUM_SETS;
+    std::size_t NUM_WAYS;
+    std::uint32_t LINE_SHIFT;
+    // NUM_SETS - 1 when it is a power of two, set index is then a mask instead of a modulo:
+    std::size_t SET_MASK;
+
+    // per-line state, indexed by set * NUM_WAYS + way:
+    std::vector<ISA::Address> tags;
+    std::vector<std::uint8_t> valid;
+    std::vector<std::uint64_t> last_used;
+
+    std::uint64_t accesses;
+    std::uint64_t misses;
+};
@@ -0,0 +1,63 @@
+#include "cpi_stack.h"
+
+/**
+    Get RAW data hazard cause from producer.
+
+    @param producer machine code of instruction the stalled one depends on.
+*/
+CPIStack::Cause CPIStack::get_data_cause(ISA::MachineCode producer) {
+    const ISA::Word opcode = ISA::get_instruction_field(producer, ISA::Field::OPCODE);
+
+    if (ISA::OpCode::LW == opcode) {
+        return DATA_LOAD;
+    }
+
+    if (ISA::OpCode::R_COMMON == opcode) {
+        const ISA::Word funct = ISA::get_instruction_field(producer, ISA::Field::FUNCT);
+
+        if (ISA::Funct::MUL == funct || ISA::Funct::MULT == funct) {
+            return DATA_MUL;
+        }
+    }
+
+    return DATA_ALU;
+}
+
+/**
+    Reset all components.
+*/
+void CPIStack::reset(void) {
+    base = 0;
+    for (std::size_t i = 0; i < NUM_CAUSES; ++i) {
+        bubbles[i] = 0;
+    }
+}
+
+/**
+    Fill CPI stack report, cycles & CPI per component.
+
+    @param report output JSON report.
+*/
+void CPIStack::report(nlohmann::json &report) const {
+    // CPI is relative to retired instructions:
+    auto component = [this](std::uint64_t cycles) -> nlohmann::json {
+        return {{"cycles", cycles}, {"CPI", (0 == base) ? 0.0 : static_cast<double>(cycles) / base}};
+    };
+
+    std::uint64_t total = base;
+    for (std::size_t i = 0; i < NUM_CAUSES; ++i) {
+        total += bubbles[i];
+    }
+
+    report = {};
+    report["base"] = component(base);
+    report["data hazard"] = {
+        {"ALU", component(bubbles[DATA_ALU])},
+        {"load", component(bubbles[DATA_LOAD])},
+        {"MUL", component(bubbles[DATA_MUL])}
+    };
+    report["control hazard"] = component(bubbles[CONTROL]);
+    report["structural hazard"] = component(bubbles[STRUCTURAL]);
+    report["fill & drain"] = component(bubbles[DRAIN]);
+    report["total"] = component(total);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cinttypes>
+
+#include "isa.h"
+#include "json.h"
+
+/**
+ *  CPI stack -- every clock cycle is charged to exactly one component at WB: base when an
+ *  instruction retires, otherwise the cause carried by the bubble, so components sum to total
+ *  clock cycles. Bubbles are tagged with their cause where they enter the pipeline.
+ */
+class CPIStack {
+public:
+    enum Cause {
+        // empty pipeline -- startup fill or nothing left to fetch:
+        DRAIN = 0,
+        // RAW data hazard, by producer type:
+        DATA_ALU = 1,
+        DATA_LOAD = 2,
+        DATA_MUL = 3,
+        // branch resolution:
+        CONTROL = 4,
+        // busy MEM stage:
+        STRUCTURAL = 5,
+        NUM_CAUSES = 6
+    };
+
+    CPIStack() {reset();}
+
+    /**
+        Get RAW data hazard cause from producer.
+
+        @param producer machine code of instruction the stalled one depends on.
+    */
+    static Cause get_data_cause(ISA::MachineCode producer);
+
+    /**
+        Charge one clock cycle.
+    */
+    void retire(void) {++base;}
+    void bubble(std::uint8_t cause) {++bubbles[cause];}
+
+    /**
+        Get clock cycles charged to retired instructions & to bubbles of cause.
+    */
+    std::uint64_t get_base(void) const {return base;}
+    std::uint64_t get_bubbles(Cause cause) const {return bubbles[cause];}
+
+    /**
+        Reset all components.
+    */
+    void reset(void);
+
+    /**
+        Fill CPI stack report, cycles & CPI per component.
+
+        @param report output JSON report.
+    */
+    void report(nlohmann::json &report) const;
+private:
+    std::uint64_t base;
+    std::uint64_t bubbles[NUM_CAUSES];
+};
@@ -0,0 +1,113 @@
+#include "decoupled.h"
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+#include "json.h"
+#include "host_timer.h"
+
+DecoupledSimulator::DecoupledSimulator(
+    ISA::TextSegment &text,
+    ISA::DataSegment &data,
+    std::size_t queue_capacity
+): text_segment(text), data_segment(data), executed(0), queue(queue_capacity), functional(text, data), timing(text, queue) {
+}
+
+/**
+    Run program.
+
+    @param MODE execution mode.
+    @param N execution time.
+*/
+void DecoupledSimulator::run(const std::string &MODE, const int N) {
+    // in instruction mode the front-end never needs to run ahead of the budget:
+    const int max_instructions = ("instruction" == MODE) ? N : -1;
+
+    // the front-end updates data memory ahead of the back-end:
+    initial_data.reset(new ISA::DataSegment(data_segment));
+
+    // functional front-end:
+    std::thread front_end(
+        [this, max_instructions]() {
+            executed = functional.run({&queue}, max_instructions);
+        }
+    );
+
+    // timing back-end:
+    timing.run(MODE, N);
+
+    front_end.join();
+}
+
+/**
+    Dump register contents & resource utilization report
+
+    @param output_filename output filename.
+*/
+void DecoupledSimulator::dump(const std::string &output_filename) {
+    HOST_TIMER(REPORT_DUMP);
+
+    std::ofstream output(output_filename);
+
+	if(!output) {
+		std::cerr << "[MIPS simulator]: ERROR -- cannot open output resource utilization file "<< output_filename <<std::endl;
+        return;
+	}
+
+    nlohmann::json execution_report;
+
+    // 1. register contents:
+    const std::vector<std::int32_t> reg = get_retired_registers();
+    execution_report["register contents"] = {};
+    for (
+        std::map<std::string, std::uint8_t>::const_iterator it = ISA::REGISTER_FILE.begin();
+        ISA::REGISTER_FILE.end() != it;
+        ++it
+    ) {
+        std::stringstream ss;
+        ss << "0x" << std::setfill ('0') << std::setw(8) << std::hex << reg[it->second];
+        execution_report["register contents"][it->first] = ss.str();
+    }
+
+    // 2. resource utilization report:
+    execution_report["resource utilization"] = {};
+    timing.report(execution_report["resource utilization"]);
+
+    output << execution_report.dump(4) << std::endl;
+
+	// close output file:
+	output.close();
+}
+
+/**
+    Get architectural register file as of the last record retired by the timing back-end.
+*/
+std::vector<std::int32_t> DecoupledSimulator::get_retired_registers(void) {
+    std::vector<std::int32_t> reg(ISA::REGISTER_FILE.size());
+
+    const std::uint64_t retired = timing.get_retired_instructions();
+    if (retired == executed || nullptr == initial_data) {
+        for (std::size_t i = 0; i < reg.size(); ++i) {
+            reg[i] = functional.get_register(i);
+        }
+        return reg;
+    }
+
+    // the front-end ran ahead, replay retired records on data memory as of the start of run:
+    ISA::DataSegment data(*initial_data);
+    FunctionalSimulator replay(text_segment, data);
+    DynamicInstruction record;
+    std::uint64_t count = 0;
+    while (count < retired && replay.step(record)) {
+        ++count;
+    }
+
+    for (std::size_t i = 0; i < reg.size(); ++i) {
+        reg[i] = replay.get_register(i);
+    }
+    return reg;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <memory>
+
+#include "isa.h"
+#include "spsc_queue.h"
+#include "dynamic_instruction.h"
+#include "functional.h"
+#include "timing.h"
+
+/**
+ *  Decoupled MIPS simulator -- functional front-end thread streams dynamic
+ *  instruction records to timing back-end thread over a lock-free queue.
+ */
+class DecoupledSimulator {
+public:
+    DecoupledSimulator(ISA::TextSegment &text, ISA::DataSegment &data, std::size_t queue_capacity = 4096);
+
+    /**
+        Run program.
+
+        @param MODE execution mode.
+        @param N execution time.
+    */
+    void run(const std::string &MODE, const int N);
+
+    /**
+        Set system state plot destination, nullptr to disable.
+
+        @param sink trace sink.
+    */
+    void set_trace_sink(TraceSink *sink) {timing.set_trace_sink(sink);}
+
+    /**
+        Get total number of instructions of last run.
+    */
+    std::int32_t get_total_instructions(void) const {return timing.get_total_instructions();}
+
+    /**
+        Dump register contents & resource utilization report, register contents as of the last
+        record retired by the timing back-end.
+
+        @param output_filename output filename.
+    */
+    void dump(const std::string &output_filename);
+private:
+    ISA::TextSegment &text_segment;
+    ISA::DataSegment &data_segment;
+    // data memory at start of last run, replayed when the front-end ran ahead of the back-end:
+    std::unique_ptr<ISA::DataSegment> initial_data;
+    std::size_t executed;
+
+    SPSCQueue<DynamicInstruction> queue;
+    FunctionalSimulator functional;
+    TimingModel timing;
+
+    /**
+        Get architectural register file as of the last record retired by the timing back-end.
+    */
+    std::vector<std::int32_t> get_retired_registers(void);
+};
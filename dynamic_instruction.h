@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cinttypes>
+
+#include "isa.h"
+
+/**
+ *  Dynamic instruction record produced by the functional front-end
+ *  and consumed by timing back-ends.
+ */
+struct DynamicInstruction {
+    // instruction address & machine code:
+    ISA::Address pc;
+    ISA::MachineCode ir;
+    // decoded operation:
+    ISA::Word opcode;
+    ISA::Word funct;
+    // source & destination register addresses:
+    std::uint8_t rs;
+    std::uint8_t rt;
+    std::uint8_t rd;
+    // register actually written, 0x0 for none:
+    std::uint8_t dest;
+    // memory access:
+    bool is_load;
+    bool is_store;
+    ISA::Address mem_address;
+    // branch outcome:
+    bool is_branch;
+    bool taken;
+    ISA::Address next_pc;
+};
@@ -0,0 +1,67 @@
+#include "dynamic_trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+DynamicTraceWriter::DynamicTraceWriter(std::FILE *output): writer(output), closed(false) {
+    DynamicTraceHeader header;
+    std::copy(DynamicTrace::MAGIC, DynamicTrace::MAGIC + sizeof(header.magic), header.magic);
+    header.version = DynamicTrace::VERSION;
+    header.record_size = sizeof(DynamicTraceRecord);
+
+    writer.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+DynamicTraceWriter::~DynamicTraceWriter() {
+    close();
+}
+
+/**
+    Append one executed instruction.
+
+    @param instruction dynamic instruction record.
+*/
+void DynamicTraceWriter::write(const DynamicInstruction &instruction) {
+    DynamicTraceRecord record;
+
+    record.pc = instruction.pc;
+    record.ir = instruction.ir;
+    record.mem_address = instruction.mem_address;
+    record.flags = (instruction.is_load ? DynamicTrace::LOAD : 0) |
+                   (instruction.is_store ? DynamicTrace::STORE : 0) |
+                   (instruction.is_branch ? DynamicTrace::BRANCH : 0) |
+                   (instruction.taken ? DynamicTrace::TAKEN : 0);
+    record.dest = instruction.dest;
+    record.reserved = 0;
+
+    writer.write(reinterpret_cast<const char *>(&record), sizeof(record));
+}
+
+/**
+    Write out all pending records.
+*/
+void DynamicTraceWriter::close(void) {
+    if (closed) {
+        return;
+    }
+    closed = true;
+
+    writer.close();
+}
+
+DynamicTraceReader::DynamicTraceReader(const std::string &input_filename): file(input_filename) {
+    const DynamicTraceHeader *header = reinterpret_cast<const DynamicTraceHeader *>(file.data());
+
+    if (
+        file.size() < sizeof(DynamicTraceHeader) ||
+        0 != std::memcmp(header->magic, DynamicTrace::MAGIC, sizeof(DynamicTrace::MAGIC)) ||
+        DynamicTrace::VERSION != header->version ||
+        sizeof(DynamicTraceRecord) != header->record_size
+    ) {
+        throw std::runtime_error("invalid dynamic trace file " + input_filename + " -- unsupported format");
+    }
+
+    records = reinterpret_cast<const DynamicTraceRecord *>(file.data() + sizeof(DynamicTraceHeader));
+    num_records = (file.size() - sizeof(DynamicTraceHeader)) / sizeof(DynamicTraceRecord);
+}
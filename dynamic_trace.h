@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+
+#include "isa.h"
+#include "async_writer.h"
+#include "pipeline_trace.h"
+#include "dynamic_instruction.h"
+
+/*
+    dynamic instruction trace layout, all fields little-endian:
+
+        DynamicTraceHeader
+        DynamicTraceRecord[...]                 one per executed instruction until end of file
+*/
+namespace DynamicTrace {
+    const char MAGIC[8] = {'M', 'I', 'P', 'S', 'D', 'Y', 'N', '1'};
+    const std::uint32_t VERSION = 1;
+
+    /*
+        bits in DynamicTraceRecord::flags
+     */
+    enum Flag {
+        LOAD = 0x01,
+        STORE = 0x02,
+        BRANCH = 0x04,
+        TAKEN = 0x08
+    };
+}
+
+struct DynamicTraceHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t record_size;
+};
+
+/**
+ *  Executed instruction with its memory address & branch outcome, the fixed-size dynamic trace record.
+ */
+struct DynamicTraceRecord {
+    ISA::Address pc;
+    ISA::MachineCode ir;
+    ISA::Address mem_address;
+    // DynamicTrace::Flag bits:
+    std::uint8_t flags;
+    // register actually written, 0x0 for none:
+    std::uint8_t dest;
+    std::uint16_t reserved;
+};
+static_assert(16 == sizeof(DynamicTraceRecord), "DynamicTraceRecord must stay packed, it is the dynamic trace record");
+
+/**
+ *  Streaming dynamic instruction trace writer.
+ */
+class DynamicTraceWriter {
+public:
+    /**
+        @param output output stream, owned.
+    */
+    DynamicTraceWriter(std::FILE *output);
+    ~DynamicTraceWriter();
+
+    /**
+        Append one executed instruction.
+
+        @param instruction dynamic instruction record.
+    */
+    void write(const DynamicInstruction &instruction);
+
+    /**
+        Write out all pending records.
+    */
+    void close(void);
+private:
+    AsyncWriter writer;
+    bool closed;
+};
+
+/**
+ *  Memory-mapped dynamic instruction trace reader.
+ */
+class DynamicTraceReader {
+public:
+    /**
+        @param input_filename input dynamic trace filename.
+    */
+    DynamicTraceReader(const std::string &input_filename);
+
+    /**
+        Get number of recorded instructions.
+    */
+    std::size_t size(void) const {return num_records;}
+
+    const DynamicTraceRecord *begin(void) const {return records;}
+    const DynamicTraceRecord *end(void) const {return records + num_records;}
+private:
+    PipelineTrace::MappedFile file;
+
+    const DynamicTraceRecord *records;
+    std::size_t num_records;
+};
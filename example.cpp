@@ -0,0 +1,63 @@
+/**
+    example.cpp
+    Purpose: Embed the MIPS simulator through the Simulator library facade
+
+    @version 1.0
+*/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <stdexcept>
+
+#include "simulator.h"
+
+namespace {
+    // store t0 + 3 to data memory word 0, t0 from data memory word 4:
+    const char *SOURCE =
+        "lw $t0 0x0004($zero)\n"
+        "addi $t1 $t0 0x0003\n"
+        "sw $t1 0x0000($zero)\n";
+
+    /**
+        Print resource utilization & register contents of last run.
+
+        @param simulator simulator after run.
+    */
+    void print(const Simulator &simulator) {
+        const Executor::Stats stats = simulator.get_stats();
+        std::cout << "\tclock cycles -- " << stats.total_clock_cycles << ", instructions -- " << stats.total_instructions << std::endl;
+
+        for (std::size_t i = 0; i < Simulator::NUM_REG; ++i) {
+            if (0 != simulator.get_register(i)) {
+                std::cout << "\t$" << i << " -- " << simulator.get_register(i) << std::endl;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        Simulator simulator;
+
+        // a. ASM file or program image from command line, built-in source otherwise:
+        if (1 < argc) {
+            simulator.load_file(argv[1]);
+        } else {
+            simulator.load_source(SOURCE);
+        }
+        simulator.run_cycles(1000);
+        std::cout << "[MIPS simulator]: example -- first run" << std::endl;
+        print(simulator);
+
+        // b. rerun on new initial data memory, reusing loaded program:
+        simulator.reset({{0x00000004, 39}});
+        simulator.run_cycles(1000);
+        std::cout << "[MIPS simulator]: example -- rerun, data memory word 0 -- " << simulator.get_memory(0x00000000) << std::endl;
+        print(simulator);
+    } catch (const std::runtime_error &e) {
+        std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -5,10 +5,12 @@
 #include <sstream>
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
 
 #include "json.h"
+#include "host_timer.h"
 
-Executor::Executor(ISA::TextSegment &text, ISA::DataSegment &data): text_segment(text), data_segment(data) {
+Executor::Executor(ISA::TextSegment &text, ISA::DataSegment &data): text_segment(text), data_segment(&data), trace_sink(nullptr), profiler(nullptr), delay_slot(false), clean(false) {
     // initialize register file:
     reg = std::vector<std::int32_t>(NUM_REG, 0x00000000);
 }
@@ -20,8 +22,11 @@ Executor::Executor(ISA::TextSegment &text, ISA::DataSegment &data): text_segment
     @param N execution time.
 */
 void Executor::run(const std::string &MODE, const int N) {
-    // initialize pipeline:
-    init();
+    // initialize pipeline, unless just reset:
+    if (!clean) {
+        init();
+    }
+    clean = false;
 
     // initialize PC:
     PC = text_segment.get_address_first();
@@ -35,7 +40,9 @@ void Executor::run(const std::string &MODE, const int N) {
         }
 
         // dump pipeline state each cycle for better illustration:
-        dump_pipeline_state();
+        if (nullptr != trace_sink) {
+            dump_pipeline_state();
+        }
 
         // execute pipeline:
         execute_pipeline();
@@ -46,18 +53,44 @@ void Executor::run(const std::string &MODE, const int N) {
 }
 
 /**
-    Dump register contents, latch values & resource utilization report   
+    Reset to clean register file & pipeline for a rerun on new data memory.
+
+    @param data data segment of next run.
 */
-void Executor::dump(const std::string &output_filename) {
-    std::ofstream output(output_filename);
+void Executor::reset(ISA::DataSegment &data) {
+    data_segment = &data;
 
-	if(!output) {
-		std::cerr << "[MIPS simulator]: ERROR -- cannot open output resource utilization file "<< output_filename <<std::endl;
-        return; 
-	}
+    // a. register file, in place:
+    std::fill(reg.begin(), reg.end(), 0x00000000);
+    HI = LO = 0x00000000;
 
-    nlohmann::json execution_report;
+    // b. pipeline latches, hazards & resource utilization of last run:
+    init();
+    clean = true;
+}
 
+/**
+    Get resource utilization of last run.
+*/
+Executor::Stats Executor::get_stats(void) const {
+    Stats stats;
+
+    stats.total_clock_cycles = monitor.total_clock_cycles;
+    stats.total_instructions = monitor.total_instructions;
+    for (std::size_t i = 0; i < Stage::NUM_STAGES; ++i) {
+        stats.nop_count[i] = monitor.nop_count[i];
+    }
+    stats.cpi_stack = monitor.cpi_stack;
+
+    return stats;
+}
+
+/**
+    Fill register contents & resource utilization report.
+
+    @param execution_report output JSON report.
+*/
+void Executor::report(nlohmann::json &execution_report) const {
     // 1. register contents:
     execution_report["register contents"] = {};
     for (
@@ -92,6 +125,25 @@ void Executor::dump(const std::string &output_filename) {
     execution_report["resource utilization"]["nop analysis"]["WB"] = { 
         {"count", monitor.nop_count[Stage::WB]}, {"percentage", (100.0 * monitor.nop_count[Stage::WB]) / monitor.total_clock_cycles} 
     };
+    monitor.instruction_mix.report(execution_report["resource utilization"]["instruction mix"]);
+    monitor.cpi_stack.report(execution_report["resource utilization"]["CPI stack"]);
+}
+
+/**
+    Dump register contents, latch values & resource utilization report   
+*/
+void Executor::dump(const std::string &output_filename) {
+    HOST_TIMER(REPORT_DUMP);
+
+    std::ofstream output(output_filename);
+
+	if(!output) {
+		std::cerr << "[MIPS simulator]: ERROR -- cannot open output resource utilization file "<< output_filename <<std::endl;
+        return; 
+	}
+
+    nlohmann::json execution_report;
+    report(execution_report);
 
     output << execution_report.dump(4) << std::endl;
 
@@ -103,7 +155,9 @@ void Executor::dump(const std::string &output_filename) {
     MIPS pipeline -- instruction fetch 
 */
 void Executor::execute_IF() {
-    if (hazard.control) {
+    HOST_TIMER(EXECUTE_IF);
+
+    if (hazard.control || delay_slot) {
         if (ISA::OpCode::BEQ == ISA::get_instruction_field(EX_MEM.IR, ISA::Field::OPCODE)) {
             // control hazard resolved:
             if (EX_MEM.Cond) {
@@ -111,12 +165,18 @@ void Executor::execute_IF() {
             }
 
             hazard.control = false;
-        } else {
+        } else if (!delay_slot) {
             // insert nop:
             IF_ID.reset();
+            IF_ID.Cause = CPIStack::CONTROL;
             monitor.nop_count[Stage::IF] += 1;
+            monitor.instruction_mix.control_stall(hazard.control_source);
+            if (nullptr != profiler) {
+                profiler->cause(hazard.control_source_pc);
+            }
             return;
-        } 
+        }
+        // otherwise fetch delay slot, executed whether the branch is taken or not
     }
 
     if (hazard.data) {
@@ -139,44 +199,74 @@ void Executor::execute_IF() {
     ISA::MachineCode instruction = text_segment.get_binary(PC);
     PC = PC + 4;
     monitor.total_instructions += 1;
+    monitor.instruction_mix.fetch(instruction);
+    monitor.instruction_mix.occupy(instruction);
+    if (nullptr != profiler) {
+        profiler->fetch(IF_ID.IPC);
+        profiler->occupy(Profiler::IF, IF_ID.IPC);
+    }
 
     IF_ID.IR = instruction;
     IF_ID.NPC = PC;
+    IF_ID.ICycle = monitor.total_clock_cycles;
 }
 /*
     MIPS pipeline -- instruction decoding 
 */
 void Executor::execute_ID() {
+    HOST_TIMER(EXECUTE_ID);
+
     if (IF_ID.nop) {
         // insert nop:
         ID_EX.reset();
+        ID_EX.Cause = IF_ID.Cause;
         monitor.nop_count[Stage::ID] += 1;
         return;
     }
 
+    monitor.instruction_mix.occupy(IF_ID.IR);
+    if (nullptr != profiler) {
+        profiler->occupy(Profiler::ID, IF_ID.IPC);
+    }
+
     ISA::Word opcode = ISA::get_instruction_field(IF_ID.IR, ISA::Field::OPCODE);
     
     // control hazard detected:
     if (ISA::OpCode::BEQ == opcode) {
         hazard.control = true;
+        hazard.control_source = IF_ID.IR;
+        hazard.control_source_pc = IF_ID.IPC;
     }
 
     ISA::Word a_reg_addr = ISA::get_instruction_field(IF_ID.IR, ISA::Field::RS);
     ISA::Word b_reg_addr = ISA::get_instruction_field(IF_ID.IR, ISA::Field::RT);
 
-    // data hazard detected:
+    // data hazard detected, charged to the nearest producer:
     if (
         (EX_MEM.WriteRegAddr != 0x0 && EX_MEM.WriteRegAddr == a_reg_addr) ||
+        (EX_MEM.WriteRegAddr != 0x0 && EX_MEM.WriteRegAddr == b_reg_addr)
+    ) {
+        hazard.data = true;
+        hazard.data_cause = CPIStack::get_data_cause(EX_MEM.IR);
+        hazard.data_source_pc = EX_MEM.IPC;
+    } else if (
         (MEM_WB.WriteRegAddr != 0x0 && MEM_WB.WriteRegAddr == a_reg_addr) ||
-        (EX_MEM.WriteRegAddr != 0x0 && EX_MEM.WriteRegAddr == b_reg_addr) ||
-        (MEM_WB.WriteRegAddr != 0x0 && MEM_WB.WriteRegAddr == b_reg_addr)     
+        (MEM_WB.WriteRegAddr != 0x0 && MEM_WB.WriteRegAddr == b_reg_addr)
     ) {
         hazard.data = true;
+        hazard.data_cause = CPIStack::get_data_cause(MEM_WB.IR);
+        hazard.data_source_pc = MEM_WB.IPC;
     }
 
     if (hazard.data) {
         ID_EX.reset();
+        ID_EX.Cause = hazard.data_cause;
         monitor.nop_count[Stage::ID] += 1;
+        monitor.instruction_mix.data_stall(IF_ID.IR);
+        if (nullptr != profiler) {
+            profiler->stall(IF_ID.IPC);
+            profiler->cause(hazard.data_source_pc);
+        }
         return;
     }
 
@@ -185,6 +275,7 @@ void Executor::execute_ID() {
     ID_EX.IR = IF_ID.IR;
     ID_EX.IPC = IF_ID.IPC;
     ID_EX.NPC = IF_ID.NPC;
+    ID_EX.ICycle = IF_ID.ICycle;
 
     ID_EX.A = reg[a_reg_addr];
     ID_EX.B = reg[b_reg_addr];
@@ -286,15 +377,24 @@ void Executor::execute_i_type_instruction(void) {
 }
 
 void Executor::execute_EX(void) {
+    HOST_TIMER(EXECUTE_EX);
+
     if (ID_EX.nop) {
         EX_MEM.reset();
+        EX_MEM.Cause = ID_EX.Cause;
         monitor.nop_count[Stage::EX] += 1;
         return;
     }
 
+    monitor.instruction_mix.occupy(ID_EX.IR);
+    if (nullptr != profiler) {
+        profiler->occupy(Profiler::EX, ID_EX.IPC);
+    }
+
     EX_MEM.nop = false;
     EX_MEM.IR = ID_EX.IR;
     EX_MEM.IPC = ID_EX.IPC;
+    EX_MEM.ICycle = ID_EX.ICycle;
     EX_MEM.B = ID_EX.B;
     EX_MEM.WriteRegAddr = ID_EX.WriteRegAddr;
 
@@ -323,15 +423,24 @@ void Executor::execute_EX(void) {
     MIPS pipeline -- memory access 
 */
 void Executor::execute_MEM() {
+    HOST_TIMER(EXECUTE_MEM);
+
     if (EX_MEM.nop) {
         MEM_WB.reset();
+        MEM_WB.Cause = EX_MEM.Cause;
         monitor.nop_count[Stage::MEM] += 1;
         return;
     }
 
+    monitor.instruction_mix.occupy(EX_MEM.IR);
+    if (nullptr != profiler) {
+        profiler->occupy(Profiler::MEM, EX_MEM.IPC);
+    }
+
     MEM_WB.nop = false;
     MEM_WB.IR = EX_MEM.IR;
     MEM_WB.IPC = EX_MEM.IPC;
+    MEM_WB.ICycle = EX_MEM.ICycle;
 
     switch (ISA::get_instruction_field(MEM_WB.IR, ISA::Field::OPCODE)) {
         case ISA::OpCode::R_COMMON:
@@ -347,14 +456,14 @@ void Executor::execute_MEM() {
             monitor.nop_count[Stage::MEM] += 1;
             break;
         case ISA::OpCode::SW:
-            data_segment.set(EX_MEM.ALUOutput, EX_MEM.B);
+            data_segment->set(EX_MEM.ALUOutput, EX_MEM.B);
             MEM_WB.ALUOutput = 0x00000000;
             MEM_WB.LMD = 0x00000000;
             MEM_WB.WriteRegAddr = 0x00000000;
             break;
         case ISA::OpCode::LW:
             MEM_WB.ALUOutput = 0x00000000;
-            MEM_WB.LMD = data_segment.get(EX_MEM.ALUOutput);
+            MEM_WB.LMD = data_segment->get(EX_MEM.ALUOutput);
             MEM_WB.WriteRegAddr = EX_MEM.WriteRegAddr;
             break;
         default:
@@ -381,11 +490,21 @@ void Executor::execute_reg_write(std::int32_t reg_addr, std::int32_t value) {
 }
 
 void Executor::execute_WB() {
+    HOST_TIMER(EXECUTE_WB);
+
     if (MEM_WB.nop) {
         monitor.nop_count[Stage::WB] += 1;
+        monitor.cpi_stack.bubble(MEM_WB.Cause);
         return;
     }
 
+    monitor.cpi_stack.retire();
+    monitor.instruction_mix.occupy(MEM_WB.IR);
+    if (nullptr != profiler) {
+        profiler->occupy(Profiler::WB, MEM_WB.IPC);
+    }
+    monitor.instruction_mix.retire(MEM_WB.IR, monitor.total_clock_cycles - MEM_WB.ICycle + 1);
+
     switch (ISA::get_instruction_field(MEM_WB.IR, ISA::Field::OPCODE)) {
         case ISA::OpCode::R_COMMON:
             switch (ISA::get_instruction_field(MEM_WB.IR, ISA::Field::FUNCT)) {
@@ -494,14 +613,29 @@ bool Executor::is_terminated(const std::string &MODE, const int N) {
 }
 
 void Executor::dump_pipeline_state(void) {
+    HOST_TIMER(TRACE_OUTPUT);
+
+    PipelineSnapshot snapshot;
+
     // clock cycle:
-    std::cout << "[Clock Cycle]: " << monitor.total_clock_cycles << std::endl;
+    snapshot.cycle = monitor.total_clock_cycles;
     // pipeline state:
-    std::cout << "\tIF: " << text_segment.get_text(PC) << std::endl;
-    std::cout << "\tID: " << text_segment.get_text(IF_ID.IPC) << std::endl;
-    std::cout << "\tEX: " << text_segment.get_text(ID_EX.IPC) << std::endl;
-    std::cout << "\tMEM: " << text_segment.get_text(EX_MEM.IPC) << std::endl;
-    std::cout << "\tWB: " << text_segment.get_text(MEM_WB.IPC) << std::endl;
-
-    std::cout << std::endl;
+    snapshot.pc[Stage::IF] = PC;
+    snapshot.pc[Stage::ID] = IF_ID.IPC;
+    snapshot.pc[Stage::EX] = ID_EX.IPC;
+    snapshot.pc[Stage::MEM] = EX_MEM.IPC;
+    snapshot.pc[Stage::WB] = MEM_WB.IPC;
+    // bubbles:
+    snapshot.nop = (
+        ((PC < text_segment.get_address_first() || PC > text_segment.get_address_last()) << Stage::IF) |
+        (IF_ID.nop << Stage::ID) | (ID_EX.nop << Stage::EX) | (EX_MEM.nop << Stage::MEM) | (MEM_WB.nop << Stage::WB)
+    );
+    // hazards:
+    snapshot.hazard = (
+        (hazard.data ? PipelineTrace::Hazard::DATA : 0x00) |
+        (hazard.control ? PipelineTrace::Hazard::CONTROL : 0x00)
+    );
+    snapshot.reserved = 0x0000;
+
+    trace_sink->record(snapshot);
 }
\ No newline at end of file
@@ -4,12 +4,37 @@
 #include <vector>
 
 #include "isa.h"
+#include "json.h"
+#include "trace_sink.h"
+#include "instruction_mix.h"
+#include "cpi_stack.h"
+#include "profiler.h"
 
 /**
  *  MIPS pipelined processor.
  */
 class Executor {
 public:
+    // pipeline stages:
+    enum Stage {
+        IF = 0,
+        ID = 1,
+        EX = 2,
+        MEM = 3,
+        WB = 4,
+        NUM_STAGES = 5
+    };
+
+    // resource utilization of last run:
+    struct Stats {
+        std::int32_t total_clock_cycles;
+        std::int32_t total_instructions;
+        // bubbles per stage:
+        std::int32_t nop_count[NUM_STAGES];
+        // clock cycles by cause, summing to total clock cycles:
+        CPIStack cpi_stack;
+    };
+
     Executor(ISA::TextSegment &text, ISA::DataSegment &data);
 
     /**
@@ -19,11 +44,68 @@ public:
     */
     void run(const std::string &MODE, const int N);
 
+    /**
+        Set system state plot destination, nullptr to disable.
+
+        @param sink trace sink.
+    */
+    void set_trace_sink(TraceSink *sink) {trace_sink = sink;}
+
+    /**
+        Set per-PC profiler, nullptr to disable.
+
+        @param instance profiler of the executed text segment.
+    */
+    void set_profiler(Profiler *instance) {profiler = instance;}
+
+    /**
+        Set branch delay slot, the instruction behind BEQ is then always executed instead of squashed.
+
+        @param enabled true to execute delay slots.
+    */
+    void set_delay_slot(bool enabled) {delay_slot = enabled;}
+
+    /**
+        Reset to clean register file & pipeline for a rerun on new data memory, keeping text segment,
+        trace sink, profiler, delay slot mode & register file storage. The next run does not clear them again.
+
+        @param data data segment of next run.
+    */
+    void reset(ISA::DataSegment &data);
+
+    /**
+        Get total number of clock cycles & instructions of last run.
+    */
+    std::int32_t get_total_clock_cycles(void) const {return monitor.total_clock_cycles;}
+    std::int32_t get_total_instructions(void) const {return monitor.total_instructions;}
+
+    /**
+        Get resource utilization of last run.
+    */
+    Stats get_stats(void) const;
+
+    /**
+        Get architectural register value.
+
+        @param reg_addr register address.
+    */
+    std::int32_t get_register(std::size_t reg_addr) const {return reg[reg_addr];}
+
+    /**
+        Fill register contents & resource utilization report.
+
+        @param execution_report output JSON report.
+    */
+    void report(nlohmann::json &execution_report) const;
+
     /**
         Dump register contents, latch values & resource utilization report   
     */
     void dump(const std::string &output_filename);
 private:
+    // microbenchmarks drive stage functions directly, see bench.cpp:
+    friend class ExecutorBench;
+
     /*
         register file
     */
@@ -36,16 +118,6 @@ private:
     /*
         pipeline
      */
-    // state:
-    enum Stage {
-        IF = 0,
-        ID = 1,
-        EX = 2,
-        MEM = 3,
-        WB = 4,
-        NUM_STAGES = 5
-    };
-
     // logic -- instruction fetch:
     void execute_IF();
     // logic -- instruction decoding:
@@ -70,10 +142,13 @@ private:
         ISA::MachineCode IR;
         ISA::Address IPC;
         ISA::Address NPC;
+        std::int32_t ICycle;
+        // CPIStack::Cause of bubble:
+        std::uint8_t Cause;
 
         void reset(void) {
             nop = true;
-            IR = IPC = NPC = 0x00000000;
+            IR = IPC = NPC = ICycle = Cause = 0x00000000;
         }
     } IF_ID;
     // register -- ID/EX:
@@ -87,10 +162,12 @@ private:
         std::int32_t B;
         std::int32_t Imm;
         std::int32_t WriteRegAddr;
+        std::int32_t ICycle;
+        std::uint8_t Cause;
 
         void reset(void) {
             nop = true;
-            IR = IPC = NPC = A = B = Imm = WriteRegAddr = 0x00000000;
+            IR = IPC = NPC = A = B = Imm = WriteRegAddr = ICycle = Cause = 0x00000000;
         }
     } ID_EX;
     // register -- EX/MEM:
@@ -103,10 +180,12 @@ private:
         std::int32_t B;
         std::uint8_t Cond;
         std::int32_t WriteRegAddr;
+        std::int32_t ICycle;
+        std::uint8_t Cause;
 
         void reset(void) {
             nop = true;
-            IR = IPC = ALUOutput = B = Cond = WriteRegAddr = 0x00000000;
+            IR = IPC = ALUOutput = B = Cond = WriteRegAddr = ICycle = Cause = 0x00000000;
         }
     } EX_MEM;
     // register -- MEM/WB
@@ -118,10 +197,12 @@ private:
         std::int64_t ALUOutput;
         std::int32_t LMD;
         std::int32_t WriteRegAddr;
+        std::int32_t ICycle;
+        std::uint8_t Cause;
 
         void reset(void) {
             nop = true;
-            IR = IPC = ALUOutput = LMD = WriteRegAddr = 0x00000000;
+            IR = IPC = ALUOutput = LMD = WriteRegAddr = ICycle = Cause = 0x00000000;
         }
     } MEM_WB;
 
@@ -129,9 +210,17 @@ private:
     struct {
         bool data;
         bool control;
+        // CPIStack::Cause & address of producer causing data hazard stalls:
+        std::uint8_t data_cause;
+        ISA::Address data_source_pc;
+        // branch that raised the control hazard:
+        ISA::MachineCode control_source;
+        ISA::Address control_source_pc;
 
         void reset(void) {
             data = control = false;
+            data_cause = CPIStack::DATA_ALU;
+            data_source_pc = control_source = control_source_pc = 0x00000000;
         }
     } hazard;
 
@@ -143,17 +232,28 @@ private:
         std::int32_t total_instructions;
         // utilization:
         std::int32_t nop_count[Stage::NUM_STAGES];
+        // instruction mix:
+        InstructionMix instruction_mix;
+        // cycles by stall cause:
+        CPIStack cpi_stack;
 
         void reset(void) {
             total_clock_cycles = total_instructions = 0;
             for (std::size_t i = 0; i < Stage::NUM_STAGES; ++i) {
                 nop_count[i] = 0;
             }
+            instruction_mix.reset();
+            cpi_stack.reset();
         }
     } monitor;
 
     ISA::TextSegment &text_segment;
-    ISA::DataSegment &data_segment;
+    ISA::DataSegment *data_segment;
+    TraceSink *trace_sink;
+    Profiler *profiler;
+    bool delay_slot;
+    // pipeline & statistics cleared by reset, so the next run skips clearing them again:
+    bool clean;
 
     void init(void);
     bool is_terminated(const std::string &MODE, const int N);
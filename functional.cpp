@@ -0,0 +1,217 @@
+#include "functional.h"
+
+FunctionalSimulator::FunctionalSimulator(ISA::TextSegment &text, ISA::DataSegment &data): text_segment(text), data_segment(data) {
+    // initialize register file:
+    reg = std::vector<std::int32_t>(NUM_REG, 0x00000000);
+    HI = LO = 0x00000000;
+
+    // initialize PC:
+    PC = text_segment.get_address_first();
+    finished = false;
+}
+
+/**
+    Execute program, broadcasting dynamic instruction records to every consumer.
+    Stops early once all consumers have cancelled their streams.
+
+    @param queues output record streams.
+    @param max_instructions instruction budget, negative for unlimited.
+    @return number of executed instructions.
+*/
+std::size_t FunctionalSimulator::run(const std::vector<SPSCQueue<DynamicInstruction>*> &queues, const int max_instructions) {
+    DynamicInstruction record;
+    std::size_t count = 0;
+
+    while (max_instructions < 0 || static_cast<int>(count) < max_instructions) {
+        if (!step(record)) {
+            break;
+        }
+        ++count;
+
+        // broadcast:
+        bool delivered = false;
+        for (auto queue: queues) {
+            if (queue->push(record)) {
+                delivered = true;
+            }
+        }
+        if (!delivered) {
+            break;
+        }
+    }
+
+    // signal end of stream:
+    for (auto queue: queues) {
+        queue->close();
+    }
+
+    return count;
+}
+
+/**
+    Execute program, recording dynamic instruction records for later replay.
+
+    @param trace output dynamic trace.
+    @param max_instructions instruction budget, negative for unlimited.
+    @return number of recorded instructions.
+*/
+std::size_t FunctionalSimulator::record(DynamicTraceWriter &trace, const int max_instructions) {
+    DynamicInstruction record;
+    std::size_t count = 0;
+
+    for (; max_instructions < 0 || static_cast<int>(count) < max_instructions; ++count) {
+        if (!step(record)) {
+            break;
+        }
+
+        trace.write(record);
+    }
+
+    trace.close();
+
+    return count;
+}
+
+/**
+    Execute instruction at current PC.
+
+    @param record output dynamic instruction record.
+    @return true if an instruction was executed, false at end of program.
+*/
+bool FunctionalSimulator::step(DynamicInstruction &record) {
+    if (
+        finished ||
+        PC < text_segment.get_address_first() ||
+        PC > text_segment.get_address_last()
+    ) {
+        return false;
+    }
+
+    // decode:
+    record.pc = PC;
+    record.ir = text_segment.get_binary(PC);
+    record.opcode = ISA::get_instruction_field(record.ir, ISA::Field::OPCODE);
+    record.funct = ISA::get_instruction_field(record.ir, ISA::Field::FUNCT);
+    record.rs = ISA::get_instruction_field(record.ir, ISA::Field::RS);
+    record.rt = ISA::get_instruction_field(record.ir, ISA::Field::RT);
+    record.rd = ISA::get_instruction_field(record.ir, ISA::Field::RD);
+    record.dest = 0x0;
+    record.is_load = record.is_store = false;
+    record.mem_address = 0x00000000;
+    record.is_branch = record.taken = false;
+    record.next_pc = PC + 4;
+
+    // execute:
+    if (ISA::OpCode::R_COMMON == record.opcode) {
+        execute_r_type_instruction(record);
+    } else {
+        execute_i_type_instruction(record);
+    }
+
+    // the pipeline drains once the last instruction in text segment retires:
+    if (text_segment.get_address_last() == PC) {
+        finished = true;
+    }
+    PC = record.next_pc;
+
+    return true;
+}
+
+void FunctionalSimulator::write_register(std::uint8_t reg_addr, std::int32_t value, DynamicInstruction &record) {
+    if (0x0 != reg_addr && NUM_REG > reg_addr) {
+        reg[reg_addr] = value;
+
+        if (0x0 == record.dest) {
+            record.dest = reg_addr;
+        }
+    }
+}
+
+void FunctionalSimulator::execute_r_type_instruction(DynamicInstruction &record) {
+    const std::int32_t A = reg[record.rs];
+    const std::int32_t B = reg[record.rt];
+    const ISA::Word shamt = ISA::get_instruction_field(record.ir, ISA::Field::SHAMT);
+
+    std::int64_t product;
+
+    switch (record.funct) {
+        case ISA::Funct::ADD:
+            write_register(record.rd, static_cast<std::int64_t>(A) + B, record);
+            break;
+        case ISA::Funct::SUB:
+            write_register(record.rd, static_cast<std::int64_t>(A) - B, record);
+            break;
+        case ISA::Funct::AND:
+            write_register(record.rd, A & B, record);
+            break;
+        case ISA::Funct::OR:
+            write_register(record.rd, A | B, record);
+            break;
+        case ISA::Funct::MUL:
+            // low word to rd, high word to rd + 1:
+            product = static_cast<std::int64_t>(A) * static_cast<std::int64_t>(B);
+            write_register(record.rd, product, record);
+            write_register(record.rd + 1, (product >> 32), record);
+            break;
+        case ISA::Funct::MULT:
+            product = static_cast<std::int64_t>(A) * static_cast<std::int64_t>(B);
+            LO = product;
+            HI = product >> 32;
+            break;
+        case ISA::Funct::SLL:
+            write_register(record.rd, static_cast<std::uint32_t>(B) << shamt, record);
+            break;
+        case ISA::Funct::SRL:
+            write_register(record.rd, B >> shamt, record);
+            break;
+        default:
+            break;
+    }
+}
+
+void FunctionalSimulator::execute_i_type_instruction(DynamicInstruction &record) {
+    const std::int32_t A = reg[record.rs];
+    const std::int32_t B = reg[record.rt];
+    // load imm by sign extension:
+    const std::int32_t Imm = static_cast<std::int16_t>(ISA::get_instruction_field(record.ir, ISA::Field::IMM));
+
+    switch (record.opcode) {
+        case ISA::OpCode::ADDI:
+            write_register(record.rt, static_cast<std::int64_t>(A) + Imm, record);
+            break;
+        case ISA::OpCode::ANDI:
+            write_register(record.rt, A & Imm, record);
+            break;
+        case ISA::OpCode::ORI:
+            write_register(record.rt, A | Imm, record);
+            break;
+        case ISA::OpCode::LUI:
+            write_register(record.rt, static_cast<std::uint32_t>(Imm) << 16, record);
+            break;
+        case ISA::OpCode::SLTI:
+            write_register(record.rt, ((A < Imm) ? (0x00000001) : (0x00000000)), record);
+            break;
+        case ISA::OpCode::SLTIU:
+            write_register(record.rt, ((A < (Imm & 0xFFFF)) ? (0x00000001) : (0x00000000)), record);
+            break;
+        case ISA::OpCode::LW:
+            record.is_load = true;
+            record.mem_address = static_cast<ISA::Address>(A + Imm);
+            write_register(record.rt, data_segment.get(record.mem_address), record);
+            break;
+        case ISA::OpCode::SW:
+            record.is_store = true;
+            record.mem_address = static_cast<ISA::Address>(A + Imm);
+            data_segment.set(record.mem_address, B);
+            break;
+        case ISA::OpCode::BEQ:
+            record.is_branch = true;
+            record.taken = (A == B);
+            if (record.taken) {
+                record.next_pc = record.pc + 4 + (static_cast<ISA::Address>(Imm) << 2);
+            }
+            break;
+        default:
+            break;
+    }
+}
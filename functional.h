@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+#include "isa.h"
+#include "spsc_queue.h"
+#include "dynamic_instruction.h"
+#include "dynamic_trace.h"
+
+/**
+ *  MIPS functional simulator -- executes one instruction at a time
+ *  and emits a dynamic instruction record for each.
+ */
+class FunctionalSimulator {
+public:
+    FunctionalSimulator(ISA::TextSegment &text, ISA::DataSegment &data);
+
+    /**
+        Execute program, broadcasting dynamic instruction records to every consumer.
+        Stops early once all consumers have cancelled their streams.
+
+        @param queues output record streams.
+        @param max_instructions instruction budget, negative for unlimited.
+        @return number of executed instructions.
+    */
+    std::size_t run(const std::vector<SPSCQueue<DynamicInstruction>*> &queues, const int max_instructions);
+
+    /**
+        Execute program, recording dynamic instruction records for later replay.
+
+        @param trace output dynamic trace.
+        @param max_instructions instruction budget, negative for unlimited.
+        @return number of recorded instructions.
+    */
+    std::size_t record(DynamicTraceWriter &trace, const int max_instructions);
+
+    /**
+        Execute instruction at current PC.
+
+        @param record output dynamic instruction record.
+        @return true if an instruction was executed, false at end of program.
+    */
+    bool step(DynamicInstruction &record);
+
+    /**
+        Get architectural register value.
+
+        @param reg_addr register address.
+    */
+    std::int32_t get_register(std::size_t reg_addr) const {return reg[reg_addr];}
+private:
+    static const std::size_t NUM_REG = 32;
+    std::vector<std::int32_t> reg;
+    std::int32_t HI, LO;
+    ISA::Address PC;
+    bool finished;
+
+    ISA::TextSegment &text_segment;
+    ISA::DataSegment &data_segment;
+
+    void write_register(std::uint8_t reg_addr, std::int32_t value, DynamicInstruction &record);
+    void execute_r_type_instruction(DynamicInstruction &record);
+    void execute_i_type_instruction(DynamicInstruction &record);
+};
@@ -0,0 +1,46 @@
+#include "host_timer.h"
+
+#include <chrono>
+#include <iomanip>
+
+namespace HostTimer {
+    std::uint64_t ticks[NUM_REGIONS] = {0};
+    std::uint64_t calls[NUM_REGIONS] = {0};
+}
+
+namespace {
+    /*
+        time stamp counter & steady clock at program start, to convert ticks into nanoseconds
+     */
+    const std::uint64_t START_TSC = HostTimer::read_tsc();
+    const std::chrono::steady_clock::time_point START_TIME = std::chrono::steady_clock::now();
+}
+
+/**
+    Write host nanoseconds & calls per region, nothing when timers are compiled out.
+
+    @param output output stream.
+*/
+void HostTimer::report(std::ostream &output) {
+#ifdef MIPS_HOST_TIMERS
+    static const char *REGION_NAME[NUM_REGIONS] = {
+        "Assembler::load", "Assembler::parse", "Assembler::schedule", "Assembler::fill_delay_slots", "Assembler::build",
+        "execute_IF", "execute_ID", "execute_EX", "execute_MEM", "execute_WB",
+        "trace output", "report dump"
+    };
+
+    // a. calibrate time stamp counter against steady clock:
+    const std::uint64_t elapsed_ticks = read_tsc() - START_TSC;
+    const double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - START_TIME).count();
+    const double ns_per_tick = (0 == elapsed_ticks) ? 0.0 : elapsed_ns / elapsed_ticks;
+
+    // b. regions:
+    for (std::size_t i = 0; i < NUM_REGIONS; ++i) {
+        output << "[MIPS simulator]: host time -- " << std::left << std::setw(18) << REGION_NAME[i] << std::right
+               << std::setw(16) << static_cast<std::uint64_t>(ticks[i] * ns_per_tick) << " ns, "
+               << calls[i] << " calls" << std::endl;
+    }
+#else
+    (void) output;
+#endif
+}
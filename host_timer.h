@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cinttypes>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+/**
+ *  Host-side instrumentation of the simulator itself -- time stamp counter based scoped timers.
+ *  Timers are compiled out unless built with -DMIPS_HOST_TIMERS, see HOST_TIMERS option in CMakeLists.txt.
+ */
+namespace HostTimer {
+    /*
+        instrumented regions
+     */
+    enum Region {
+        ASSEMBLER_LOAD,
+        ASSEMBLER_PARSE,
+        ASSEMBLER_SCHEDULE,
+        ASSEMBLER_FILL_DELAY_SLOTS,
+        ASSEMBLER_BUILD,
+        EXECUTE_IF,
+        EXECUTE_ID,
+        EXECUTE_EX,
+        EXECUTE_MEM,
+        EXECUTE_WB,
+        TRACE_OUTPUT,
+        REPORT_DUMP,
+        NUM_REGIONS
+    };
+
+    /*
+        accumulated ticks & calls per region. Each region is only timed from one thread at a time.
+     */
+    extern std::uint64_t ticks[NUM_REGIONS];
+    extern std::uint64_t calls[NUM_REGIONS];
+
+    /**
+        Read time stamp counter, nanoseconds on hosts without one.
+    */
+    inline std::uint64_t read_tsc(void) {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+#endif
+    }
+
+    /**
+     *  Accumulate ticks spent inside enclosing scope.
+     */
+    class ScopedTimer {
+    public:
+        ScopedTimer(Region region): REGION(region), start(read_tsc()) {}
+        ~ScopedTimer() {
+            ticks[REGION] += read_tsc() - start;
+            calls[REGION] += 1;
+        }
+    private:
+        const Region REGION;
+        const std::uint64_t start;
+    };
+
+    /**
+        Write host nanoseconds & calls per region, nothing when timers are compiled out.
+
+        @param output output stream.
+    */
+    void report(std::ostream &output);
+}
+
+#ifdef MIPS_HOST_TIMERS
+#define HOST_TIMER_CONCAT_(a, b) a##b
+#define HOST_TIMER_CONCAT(a, b) HOST_TIMER_CONCAT_(a, b)
+#define HOST_TIMER(region) HostTimer::ScopedTimer HOST_TIMER_CONCAT(host_timer_, __LINE__)(HostTimer::region)
+#else
+#define HOST_TIMER(region)
+#endif
@@ -0,0 +1,94 @@
+#include "instruction_mix.h"
+
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+
+/**
+    Get instruction class name, i.e. its mnemonic.
+
+    @param instruction_class instruction class.
+*/
+std::string InstructionMix::get_class_name(std::size_t instruction_class) {
+    // R-type, by funct:
+    if (64 > instruction_class) {
+        switch (instruction_class) {
+            case ISA::Funct::ADD: return "add";
+            case ISA::Funct::SUB: return "sub";
+            case ISA::Funct::AND: return "and";
+            case ISA::Funct::OR: return "or";
+            case ISA::Funct::MUL: return "mul";
+            case ISA::Funct::MULT: return "mult";
+            case ISA::Funct::SLL: return "sll";
+            case ISA::Funct::SRL: return "srl";
+            default: break;
+        }
+    } else {
+        switch (instruction_class - 64) {
+            case ISA::OpCode::ADDI: return "addi";
+            case ISA::OpCode::ANDI: return "andi";
+            case ISA::OpCode::ORI: return "ori";
+            case ISA::OpCode::SLTI: return "slti";
+            case ISA::OpCode::SLTIU: return "sltiu";
+            case ISA::OpCode::BEQ: return "beq";
+            case ISA::OpCode::LUI: return "lui";
+            case ISA::OpCode::LW: return "lw";
+            case ISA::OpCode::SW: return "sw";
+            default: break;
+        }
+    }
+
+    // unknown encoding:
+    std::stringstream ss;
+    ss << ((64 > instruction_class) ? "funct-0x" : "opcode-0x") << std::setfill('0') << std::setw(2) << std::hex << (instruction_class & 0x3F);
+
+    return ss.str();
+}
+
+/**
+    Reset all counters.
+*/
+void InstructionMix::reset(void) {
+    std::memset(count, 0, sizeof(count));
+    std::memset(cycles, 0, sizeof(cycles));
+    std::memset(data_stalls, 0, sizeof(data_stalls));
+    std::memset(control_stalls, 0, sizeof(control_stalls));
+    std::memset(latency_histogram, 0, sizeof(latency_histogram));
+}
+
+/**
+    Fill instruction mix report, one entry per executed instruction class.
+
+    @param report output JSON report.
+*/
+void InstructionMix::report(nlohmann::json &report) const {
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < NUM_CLASSES; ++i) {
+        total += count[i];
+    }
+
+    report = nlohmann::json::object();
+    for (std::size_t i = 0; i < NUM_CLASSES; ++i) {
+        if (0 == count[i] && 0 == cycles[i]) {
+            continue;
+        }
+
+        nlohmann::json &entry = report[get_class_name(i)];
+
+        entry["count"] = count[i];
+        entry["percentage"] = (0 == total) ? 0.0 : (100.0 * count[i]) / total;
+        entry["cycles in flight"] = cycles[i];
+        entry["stall cycles"] = {{"data", data_stalls[i]}, {"control", control_stalls[i]}};
+
+        // retire latency, last bucket holds MAX_LATENCY - 1 and above, labeled ">=MAX_LATENCY - 1":
+        entry["latency histogram"] = nlohmann::json::array();
+        for (std::size_t latency = 0; latency < MAX_LATENCY; ++latency) {
+            if (0 == latency_histogram[i][latency]) {
+                continue;
+            }
+
+            const nlohmann::json label = (MAX_LATENCY - 1 == latency) ? nlohmann::json(">=" + std::to_string(latency)) : nlohmann::json(latency);
+            entry["latency histogram"].push_back({{"latency", label}, {"count", latency_histogram[i][latency]}});
+        }
+    }
+}
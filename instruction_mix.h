@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cinttypes>
+
+#include "isa.h"
+#include "json.h"
+
+/**
+ *  Per-instruction-class counters -- dynamic instruction mix, cycles in flight,
+ *  stall cycles & retire latency histogram. One class per ISA::Funct for R-type
+ *  instructions & per ISA::OpCode otherwise.
+ */
+class InstructionMix {
+public:
+    static const std::size_t NUM_CLASSES = 128;
+    // latencies of MAX_LATENCY - 1 and above share the last histogram bucket:
+    static const std::size_t MAX_LATENCY = 32;
+
+    InstructionMix() {reset();}
+
+    /**
+        Get instruction class.
+
+        @param machine_code instruction machine code.
+    */
+    static std::size_t get_class(ISA::MachineCode machine_code) {
+        const ISA::Word opcode = machine_code >> 26;
+
+        return (ISA::OpCode::R_COMMON == opcode) ? (machine_code & 0x3F) : (64 + opcode);
+    }
+
+    /**
+        Get instruction class name, i.e. its mnemonic.
+
+        @param instruction_class instruction class.
+    */
+    static std::string get_class_name(std::size_t instruction_class);
+
+    /**
+        Record fetched instruction.
+    */
+    void fetch(ISA::MachineCode machine_code) {++count[get_class(machine_code)];}
+    /**
+        Record one clock cycle spent by instruction inside a pipeline stage.
+    */
+    void occupy(ISA::MachineCode machine_code) {++cycles[get_class(machine_code)];}
+    /**
+        Record one bubble caused by instruction -- held back by a data hazard or blocking fetch as a branch.
+    */
+    void data_stall(ISA::MachineCode machine_code) {++data_stalls[get_class(machine_code)];}
+    void control_stall(ISA::MachineCode machine_code) {++control_stalls[get_class(machine_code)];}
+    /**
+        Record retired instruction.
+
+        @param machine_code instruction machine code.
+        @param latency clock cycles from fetch to write back, inclusive.
+    */
+    void retire(ISA::MachineCode machine_code, std::uint32_t latency) {
+        ++latency_histogram[get_class(machine_code)][(latency < MAX_LATENCY) ? latency : MAX_LATENCY - 1];
+    }
+
+    /**
+        Reset all counters.
+    */
+    void reset(void);
+
+    /**
+        Fill instruction mix report, one entry per executed instruction class.
+
+        @param report output JSON report.
+    */
+    void report(nlohmann::json &report) const;
+private:
+    std::uint64_t count[NUM_CLASSES];
+    std::uint64_t cycles[NUM_CLASSES];
+    std::uint64_t data_stalls[NUM_CLASSES];
+    std::uint64_t control_stalls[NUM_CLASSES];
+    std::uint64_t latency_histogram[NUM_CLASSES][MAX_LATENCY];
+};
@@ -1,5 +1,95 @@
 #include "isa.h"
 
+namespace {
+    /*
+        disassembler operand formats
+     */
+    enum Format {
+        UNKNOWN,
+        // op $rd $rs $rt
+        R_3,
+        // op $rs $rt
+        R_2,
+        // op $rd $rt shamt
+        R_SHIFT,
+        // op $rt $rs imm
+        I_ARITHMETIC,
+        // op $rs $rt offset
+        I_BRANCH,
+        // op $rt imm
+        I_UPPER,
+        // op $rt imm($rs)
+        I_MEMORY
+    };
+
+    struct Mnemonic {
+        const char *name;
+        Format format;
+    };
+
+    /*
+        disassembler tables, I-type by opcode, R-type by funct, register names by address
+     */
+    struct DisassemblyTables {
+        Mnemonic opcode[64];
+        Mnemonic funct[64];
+        const char *register_name[32];
+
+        DisassemblyTables() {
+            for (std::size_t i = 0; i < 64; ++i) {
+                opcode[i] = funct[i] = {nullptr, UNKNOWN};
+            }
+
+            funct[ISA::Funct::ADD] = {"add", R_3};
+            funct[ISA::Funct::SUB] = {"sub", R_3};
+            funct[ISA::Funct::AND] = {"and", R_3};
+            funct[ISA::Funct::OR] = {"or", R_3};
+            funct[ISA::Funct::MUL] = {"mul", R_3};
+            funct[ISA::Funct::MULT] = {"mult", R_2};
+            funct[ISA::Funct::SLL] = {"sll", R_SHIFT};
+            funct[ISA::Funct::SRL] = {"srl", R_SHIFT};
+
+            opcode[ISA::OpCode::ADDI] = {"addi", I_ARITHMETIC};
+            opcode[ISA::OpCode::ANDI] = {"andi", I_ARITHMETIC};
+            opcode[ISA::OpCode::ORI] = {"ori", I_ARITHMETIC};
+            opcode[ISA::OpCode::SLTI] = {"slti", I_ARITHMETIC};
+            opcode[ISA::OpCode::SLTIU] = {"sltiu", I_ARITHMETIC};
+            opcode[ISA::OpCode::BEQ] = {"beq", I_BRANCH};
+            opcode[ISA::OpCode::LUI] = {"lui", I_UPPER};
+            opcode[ISA::OpCode::LW] = {"lw", I_MEMORY};
+            opcode[ISA::OpCode::SW] = {"sw", I_MEMORY};
+
+            for (const auto &entry: ISA::REGISTER_FILE) {
+                register_name[entry.second] = entry.first.c_str();
+            }
+        }
+    };
+
+    const DisassemblyTables TABLES;
+
+    const char HEX_DIGIT[] = "0123456789abcdef";
+
+    void append(char *&output, const char *text) {
+        while ('\0' != *text) {
+            *output++ = *text++;
+        }
+    }
+
+    void append_register(char *&output, ISA::Word address) {
+        *output++ = ' ';
+        *output++ = '$';
+        append(output, TABLES.register_name[address]);
+    }
+
+    void append_hex(char *&output, ISA::Word value, std::size_t digits) {
+        *output++ = '0';
+        *output++ = 'x';
+        for (std::size_t i = digits; i > 0; --i) {
+            *output++ = HEX_DIGIT[0xF & (value >> (4 * (i - 1)))];
+        }
+    }
+}
+
 void ISA::set_instruction_field(ISA::MachineCode &machine_code, ISA::Field field, ISA::Word value) {
     switch (field) {
         case OPCODE:
@@ -58,4 +148,101 @@ ISA::Word ISA::get_instruction_field(const ISA::MachineCode &machine_code, ISA::
     }
 
     return value;
-}
\ No newline at end of file
+}
+
+/**
+    Disassemble machine code into canonical assembler syntax, assembled back to the same machine code.
+    Codes the assembler cannot produce are rendered as ".word 0x%08x".
+
+    @param machine_code instruction machine code.
+    @param output output buffer of DISASSEMBLY_SIZE characters, null-terminated.
+    @return length of disassembly.
+*/
+std::size_t ISA::disassemble(ISA::MachineCode machine_code, char *output) {
+    const Word opcode = get_instruction_field(machine_code, Field::OPCODE);
+    const Word rs = get_instruction_field(machine_code, Field::RS);
+    const Word rt = get_instruction_field(machine_code, Field::RT);
+    const Word rd = get_instruction_field(machine_code, Field::RD);
+    const Word shamt = get_instruction_field(machine_code, Field::SHAMT);
+    const Word imm = get_instruction_field(machine_code, Field::IMM);
+
+    const Mnemonic &mnemonic = (OpCode::R_COMMON == opcode) ? TABLES.funct[get_instruction_field(machine_code, Field::FUNCT)] : TABLES.opcode[opcode];
+
+    // fields outside operand format must be zero to assemble back:
+    bool valid = true;
+    switch (mnemonic.format) {
+        case R_3:
+            valid = (0 == shamt);
+            break;
+        case R_2:
+            valid = (0 == rd && 0 == shamt);
+            break;
+        case R_SHIFT:
+            valid = (0 == rs);
+            break;
+        case I_UPPER:
+            valid = (0 == rs);
+            break;
+        case UNKNOWN:
+            valid = false;
+            break;
+        default:
+            break;
+    }
+
+    char *end = output;
+    if (!valid) {
+        append(end, ".word ");
+        append_hex(end, machine_code, 8);
+    } else {
+        append(end, mnemonic.name);
+        switch (mnemonic.format) {
+            case R_3:
+                append_register(end, rd);
+                append_register(end, rs);
+                append_register(end, rt);
+                break;
+            case R_2:
+                append_register(end, rs);
+                append_register(end, rt);
+                break;
+            case R_SHIFT:
+                append_register(end, rd);
+                append_register(end, rt);
+                *end++ = ' ';
+                append_hex(end, shamt, 2);
+                break;
+            case I_ARITHMETIC:
+                append_register(end, rt);
+                append_register(end, rs);
+                *end++ = ' ';
+                append_hex(end, imm, 4);
+                break;
+            case I_BRANCH:
+                append_register(end, rs);
+                append_register(end, rt);
+                *end++ = ' ';
+                append_hex(end, imm, 4);
+                break;
+            case I_UPPER:
+                append_register(end, rt);
+                *end++ = ' ';
+                append_hex(end, imm, 4);
+                break;
+            case I_MEMORY:
+                append_register(end, rt);
+                *end++ = ' ';
+                append_hex(end, imm, 4);
+                *end++ = '(';
+                *end++ = '$';
+                append(end, TABLES.register_name[rs]);
+                *end++ = ')';
+                break;
+            default:
+                break;
+        }
+    }
+    *end = '\0';
+
+    return end - output;
+}
@@ -1,8 +1,10 @@
 #pragma once 
 
 #include <string>
+#include <string_view>
 #include <cinttypes>
 #include <map>
+#include <vector>
 
 namespace ISA {
     /*
@@ -102,18 +104,35 @@ namespace ISA {
     void set_instruction_field(MachineCode &machine_code, Field field, Word value);
     Word get_instruction_field(const MachineCode &machine_code, Field field);
 
+    // longest disassembly, with terminating null:
+    const std::size_t DISASSEMBLY_SIZE = 32;
+
+    /**
+        Disassemble machine code into canonical assembler syntax, assembled back to the same machine code.
+        Codes the assembler cannot produce are rendered as ".word 0x%08x".
+
+        @param machine_code instruction machine code.
+        @param output output buffer of DISASSEMBLY_SIZE characters, null-terminated.
+        @return length of disassembly.
+    */
+    std::size_t disassemble(MachineCode machine_code, char *output);
+
     /*
-        instruction memory
+        instruction memory, source text kept in one pool referenced by offset
      */
     struct Instruction {
     public:
         std::uint32_t binary;
-        std::string text;
+        std::uint32_t text_offset;
+        std::uint32_t text_size;
     };
 
     class TextSegment {
     public:
         TextSegment() {}
+
+        bool is_empty(void) const {return instruction_memory.empty();}
+
         /**
             Get first & last addresses of text segment.
         */
@@ -128,25 +147,44 @@ namespace ISA {
             Set instruction in text segment.
 
             @param address instruction address.
-            @param machine_code instruction machine code.
+            @param binary instruction machine code.
+            @param text instruction source text, copied into text pool.
         */
-        void set(Address address, Instruction instruction) {
-            instruction_memory.insert(
-                {address, instruction}
-            );
+        void set(Address address, MachineCode binary, std::string_view text) {
+            const Instruction instruction = {
+                binary, static_cast<std::uint32_t>(text_pool.size()), static_cast<std::uint32_t>(text.size())
+            };
+
+            if (instruction_memory.insert({address, instruction}).second) {
+                text_pool.append(text);
+            }
+        }
+
+        /**
+            Discard source text, instructions are then rendered by the disassembler.
+        */
+        void drop_text(void) {
+            for (auto &entry: instruction_memory) {
+                entry.second.text_offset = entry.second.text_size = 0;
+            }
+            std::string().swap(text_pool);
         }
 
         /**
-            Get instruction from text segment.
+            Get instruction from text segment, disassembled without source text, valid until next get_text or set.
 
             @param address instruction address.
         */
-        std::string get_text(Address address) {
+        std::string_view get_text(Address address) {
             if (address < instruction_memory.begin()->first || address > instruction_memory.rbegin()->first) {
                 return "nop";
             }
 
-            return (instruction_memory.find(address)->second).text;
+            const Instruction &instruction = instruction_memory.find(address)->second;
+            if (0 == instruction.text_size) {
+                return std::string_view(disassembly, disassemble(instruction.binary, disassembly));
+            }
+            return std::string_view(text_pool).substr(instruction.text_offset, instruction.text_size);
         } 
         std::uint32_t get_binary(Address address) {
             if (address < instruction_memory.begin()->first || address > instruction_memory.rbegin()->first) {
@@ -157,6 +195,8 @@ namespace ISA {
         } 
     private:
         std::map<Address, Instruction> instruction_memory;
+        std::string text_pool;
+        char disassembly[DISASSEMBLY_SIZE];
     };
 
     /*
@@ -165,12 +205,14 @@ namespace ISA {
     class DataSegment {
     public:
         DataSegment(Word default_word): DEFAULT(default_word) {}
+        // spare nodes stay with their segment:
+        DataSegment(const DataSegment &other): DEFAULT(other.DEFAULT), data_memory(other.data_memory) {}
 
         Word get(Address address) {
-            auto result = data_memory.find(address);
+            auto result = data_memory.lower_bound(address);
 
-            if (data_memory.end() == result) {
-                data_memory.insert({address, DEFAULT});
+            if (data_memory.end() == result || address != result->first) {
+                insert(result, address, DEFAULT);
                 return DEFAULT;
             }
 
@@ -178,10 +220,39 @@ namespace ISA {
         }
 
         void set(Address address, Word word) {
-            data_memory.insert({address, word});
+            auto result = data_memory.lower_bound(address);
+
+            if (data_memory.end() == result || address != result->first) {
+                insert(result, address, word);
+            }
+        }
+
+        /**
+            Restore every word to default, for a rerun on the same segment. Map nodes are kept
+            for reuse by later words, so refilling & rerunning allocates nothing.
+        */
+        void clear(void) {
+            while (!data_memory.empty()) {
+                spare.push_back(data_memory.extract(data_memory.begin()));
+            }
         }
     private:
         const Word DEFAULT;
         std::map<Address, Word> data_memory;
+        // nodes of cleared words:
+        std::vector<std::map<Address, Word>::node_type> spare;
+
+        void insert(std::map<Address, Word>::const_iterator hint, Address address, Word word) {
+            if (spare.empty()) {
+                data_memory.emplace_hint(hint, address, word);
+                return;
+            }
+
+            std::map<Address, Word>::node_type node = std::move(spare.back());
+            spare.pop_back();
+            node.key() = address;
+            node.mapped() = word;
+            data_memory.insert(hint, std::move(node));
+        }
     };
 }
@@ -10,11 +10,18 @@
 #include <iomanip>
 #include <fstream>
 #include <string>
+#include <chrono>
+#include <filesystem>
 
 #include <boost/program_options.hpp>
 
 #include "assembler.h"
+#include "program_image.h"
 #include "executor.h"
+#include "decoupled.h"
+#include "sweep.h"
+#include "functional.h"
+#include "host_timer.h"
 
 namespace po = boost::program_options;
 
@@ -23,23 +30,61 @@ namespace po = boost::program_options;
 
     @param argc the argc from main.
     @param argv the argv from main.
-    @param input_asm the input MIPS ASM file.
+    @param input_asm the input MIPS ASM file or binary program image.
     @param mode execution mode
     @param N execution count
+    @param engine simulation engine
+    @param sweep timing configuration sweep file
+    @param trace system state plot format
+    @param trace_output system state plot output file
+    @param record_trace dynamic instruction trace output file
+    @param profile annotated instruction image output file
+    @param jobs number of assembler threads
+    @param image binary program image output file
+    @param cache assembled program image cache directory
+    @param stream assemble straight into program image with bounded memory
+    @param image_lines sidecar line table output file of streaming assembly
+    @param disassemble render instructions from machine code instead of keeping source text
+    @param schedule reorder independent instructions inside basic blocks to reduce data hazard stalls
+    @param delay_slot always execute the instruction behind each branch
+    @param fill_delay_slots insert a delay slot behind every branch, filled with an independent instruction where safe
+    @param output_dir directory of instruction image, symbol map & resource utilization dumps
     @return true for successful parsing otherwise false.
 */
 bool parse_command_line_args(
     int argc, char** argv,
-    std::string& input_asm, std::string& mode,int& N
+    std::string& input_asm, std::string& mode,int& N,
+    std::string& engine, std::string& sweep,
+    std::string& trace, std::string& trace_output,
+    std::string& record_trace, std::string& profile,
+    std::size_t& jobs, std::string& image, std::string& cache,
+    bool& stream, std::string& image_lines, bool& disassemble, bool& schedule,
+    bool& delay_slot, bool& fill_delay_slots, std::string& output_dir
 ) {
     try {
         // set parser:
         po::options_description desc("MIPS simulator usage");
         desc.add_options()
           ("help",    "produce help message")
-          ("input",   po::value<std::string>(&input_asm)->required(), "set input ASM")
+          ("input",   po::value<std::string>(&input_asm)->required(), "set input ASM or binary program image")
           ("mode",    po::value<std::string>(&mode)->required(),      "set execution mode")
           ("number",  po::value<int>(&N)->required(),                 "set execution number")
+          ("engine",  po::value<std::string>(&engine)->default_value("pipeline"), "set simulation engine -- pipeline or decoupled")
+          ("sweep",   po::value<std::string>(&sweep),                 "set timing configuration sweep file, one functional pass feeds all configurations")
+          ("trace",   po::value<std::string>(&trace)->default_value("text"), "set system state plot format -- off, text, binary or packed")
+          ("trace-output", po::value<std::string>(&trace_output),     "set system state plot output file, stdout by default")
+          ("record-trace", po::value<std::string>(&record_trace),     "record dynamic instruction trace for tracereplay")
+          ("profile", po::value<std::string>(&profile),               "profile pipelined executor per instruction, dump annotated instruction image")
+          ("jobs",    po::value<std::size_t>(&jobs)->default_value(1), "set number of assembler threads, 0 for one per hardware thread")
+          ("image",   po::value<std::string>(&image),                 "dump binary program image, loadable as --input without assembly")
+          ("cache",   po::value<std::string>(&cache),                 "set assembled program image cache directory, keyed by input ASM content")
+          ("stream",  po::bool_switch(&stream),                       "assemble straight into --image with bounded memory, without source text")
+          ("image-lines", po::value<std::string>(&image_lines),       "set sidecar line table output file of streaming assembly")
+          ("disassemble", po::bool_switch(&disassemble),              "render instructions from machine code instead of keeping source text")
+          ("schedule", po::bool_switch(&schedule),                    "reorder independent instructions inside basic blocks to reduce data hazard stalls")
+          ("delay-slot", po::bool_switch(&delay_slot),                "always execute the instruction behind each branch, pipelined executor only")
+          ("fill-delay-slots", po::bool_switch(&fill_delay_slots),    "insert a delay slot behind every branch, filled with an independent instruction where safe")
+          ("output-dir", po::value<std::string>(&output_dir)->default_value("../output"), "set directory of instruction image, symbol map & resource utilization dumps")
         ;
 
         // parse arguments:
@@ -57,6 +102,45 @@ bool parse_command_line_args(
         if (vm.count("mode") && !("instruction" == mode || "cycle" == mode)) {
             throw std::runtime_error("invalid execution mode -- (either instruction or cycle ONLY)");    
         }
+
+        // c. simulation engine:
+        if (!("pipeline" == engine || "decoupled" == engine)) {
+            throw std::runtime_error("invalid simulation engine -- (either pipeline or decoupled ONLY)");
+        }
+
+        // d. system state plot:
+        if (!("off" == trace || "text" == trace || "binary" == trace || "packed" == trace)) {
+            throw std::runtime_error("invalid trace format -- (off, text, binary or packed ONLY)");
+        }
+        if (("binary" == trace || "packed" == trace) && trace_output.empty()) {
+            throw std::runtime_error(trace + " trace requires --trace-output");
+        }
+
+        // e. profiler:
+        if (!profile.empty() && ("pipeline" != engine || !sweep.empty())) {
+            throw std::runtime_error("profile requires the pipeline engine");
+        }
+
+        // f. streaming assembly:
+        if (stream && (image.empty() || !cache.empty())) {
+            throw std::runtime_error("stream requires --image and no --cache");
+        }
+        if (!image_lines.empty() && !stream) {
+            throw std::runtime_error("image-lines requires --stream");
+        }
+
+        // g. instruction scheduling:
+        if (schedule && stream) {
+            throw std::runtime_error("schedule requires assembly without --stream");
+        }
+
+        // h. branch delay slots:
+        if (delay_slot && ("pipeline" != engine || !sweep.empty() || !record_trace.empty())) {
+            throw std::runtime_error("delay-slot requires the pipeline engine, without --sweep or --record-trace");
+        }
+        if (fill_delay_slots && (!delay_slot || stream)) {
+            throw std::runtime_error("fill-delay-slots requires --delay-slot and assembly without --stream");
+        }
     }
     catch(std::runtime_error& e) {
         std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << "\n";
@@ -66,29 +150,206 @@ bool parse_command_line_args(
     return true;
 }
 
+/**
+    Report simulator throughput in simulated instructions per host second.
+
+    @param instructions number of simulated instructions.
+    @param elapsed host time spent simulating.
+*/
+void report_throughput(std::int64_t instructions, std::chrono::steady_clock::duration elapsed) {
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    const double kips = (0.0 == seconds) ? 0.0 : instructions / seconds / 1000.0;
+
+    std::clog << "[MIPS simulator]: simulated " << instructions << " instructions in " << seconds << " s -- "
+              << ((1000.0 <= kips) ? kips / 1000.0 : kips) << ((1000.0 <= kips) ? " MIPS" : " KIPS") << std::endl;
+}
+
 int main(int argc, char* argv[]) {
     // simulator configuration:
-    std::string input_asm, mode;
+    std::string input_asm, mode, engine, sweep, trace, trace_output, record_trace, profile, image, cache, image_lines, output_dir;
     int N;   
+    std::size_t jobs;
+    bool stream, disassemble, schedule, delay_slot, fill_delay_slots;
 
     // parse configuration:
-    if (parse_command_line_args(argc, argv, input_asm, mode, N)) {
+    if (parse_command_line_args(argc, argv, input_asm, mode, N, engine, sweep, trace, trace_output, record_trace, profile, jobs, image, cache, stream, image_lines, disassemble, schedule, delay_slot, fill_delay_slots, output_dir)) {
         std::cout << "[MIPS simulator]: input ASM -- " << input_asm << ", mode -- " << mode << ", number -- " << N << std::endl; 
 
-        // assemble:
-        Assembler assembler(input_asm);
-        // dump output for debugging:
-        assembler.dump("../output/instruction-image.bin");
+        // dump directory:
+        {
+            std::error_code error;
+            std::filesystem::create_directories(output_dir, error);
+        }
+
+        // content-addressed program image cache:
+        std::string cached_image;
+        if (!cache.empty() && !ProgramImage::is_image(input_asm)) {
+            const std::string key = Assembler::fingerprint(input_asm, 0x00400000, schedule, fill_delay_slots);
+            if (!key.empty()) {
+                std::error_code error;
+                std::filesystem::create_directories(cache, error);
+                cached_image = cache + "/" + key + ".img";
+            }
+        }
+        const bool cache_hit = !cached_image.empty() && ProgramImage::is_image(cached_image);
+        if (!cached_image.empty()) {
+            std::clog << "[MIPS simulator]: assembly cache " << (cache_hit ? "hit" : "miss") << " -- " << cached_image << std::endl;
+        }
+
+        ISA::TextSegment text_segment;
+        ProgramImage::DataWords initial_data;
+        std::string program = cache_hit ? cached_image : input_asm;
+        if (stream && !ProgramImage::is_image(program)) {
+            // assemble straight into program image with bounded memory, then load it:
+            try {
+                Assembler::stream(input_asm, image, image_lines, 0x00400000, jobs);
+            } catch (const std::runtime_error &e) {
+                std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << std::endl;
+                return 1;
+            }
+            program = image;
+        }
+        if (ProgramImage::is_image(program)) {
+            // load program image, skipping assembly:
+            try {
+                ProgramImageReader reader(program);
+                // keep source text of cached image for debug output, dropped below if disassembling:
+                text_segment = reader.get_text_segment(cache_hit || !disassemble);
+                initial_data = reader.get_data();
+
+                if (cache_hit) {
+                    // same outputs as assembly on cache miss:
+                    Assembler::dump(text_segment, output_dir + "/instruction-image.bin");
+                    Assembler::dump_symbols(reader.get_symbols(), output_dir + "/instruction-image.sym");
+                    std::error_code error;
+                    if (!image.empty() && !std::filesystem::equivalent(cached_image, image, error)) {
+                        std::filesystem::copy_file(cached_image, image, std::filesystem::copy_options::overwrite_existing, error);
+                        if (error) {
+                            throw std::runtime_error("cannot copy cached program image to " + image + " -- " + error.message());
+                        }
+                    }
+                }
+
+                std::clog << "[MIPS simulator]: program image -- text segment [";
+                std::clog << "0x" << std::setfill('0') << std::setw(8) << std::hex << text_segment.get_address_first();
+                std::clog << ", ";
+                std::clog << "0x" << std::setfill('0') << std::setw(8) << std::hex << text_segment.get_address_last();
+                std::clog << std::dec << "]" << std::endl;
+            } catch (const std::runtime_error &e) {
+                std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << std::endl;
+                return 1;
+            }
+        } else {
+            // assemble:
+            Assembler assembler(input_asm, 0x00400000, jobs, schedule, fill_delay_slots);
+            // dump output for debugging:
+            assembler.dump(output_dir + "/instruction-image.bin");
+            assembler.dump_symbols(output_dir + "/instruction-image.sym");
+            // only clean programs are stored, a cache hit would skip their syntax errors:
+            if (0 == assembler.get_num_errors()) {
+                if (!image.empty()) {
+                    assembler.dump_image(image);
+                }
+                if (!cached_image.empty()) {
+                    assembler.dump_image(cached_image);
+                }
+            }
+
+            text_segment = assembler.get_text_segment();
+        }
+
+        // source text of assembled program, disassembled on demand instead:
+        if (disassemble) {
+            text_segment.drop_text();
+        }
 
         // execute:
-        ISA::TextSegment text_segment = assembler.get_text_segment();
         ISA::DataSegment data_segment(0x00000000);
+        for (const auto &word: initial_data) {
+            data_segment.set(word.first, word.second);
+        }
+
+        // system state plot:
+        std::unique_ptr<TraceSink> trace_sink;
+        try {
+            trace_sink = TraceSink::create(trace, trace_output, text_segment);
+        } catch (const std::runtime_error &e) {
+            std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << std::endl;
+            return 1;
+        }
+
+        // dynamic instruction trace, recorded by a separate functional pass:
+        if (!record_trace.empty()) {
+            std::FILE *output = std::fopen(record_trace.c_str(), "wb");
+            if (nullptr == output) {
+                std::cerr << "[MIPS simulator]: ERROR -- cannot open output dynamic trace file " << record_trace << std::endl;
+                return 1;
+            }
 
-        Executor executor(text_segment, data_segment);
+            ISA::DataSegment record_data_segment(0x00000000);
+            for (const auto &word: initial_data) {
+                record_data_segment.set(word.first, word.second);
+            }
+            FunctionalSimulator functional(text_segment, record_data_segment);
+            DynamicTraceWriter writer(output);
 
-        executor.run(mode, N);
+            functional.record(writer, ("instruction" == mode) ? N : -1);
+        }
+
+        if (!sweep.empty()) {
+            // one functional front-end feeding all timing back-ends:
+            std::vector<TimingConfig> configs;
+            try {
+                configs = SweepSimulator::load_configs(sweep);
+            } catch (const std::runtime_error &e) {
+                std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << std::endl;
+                return 1;
+            }
+
+            SweepSimulator simulator(text_segment, data_segment, configs);
+
+            const auto start = std::chrono::steady_clock::now();
+            simulator.run(mode, N);
+            report_throughput(simulator.get_total_instructions(), std::chrono::steady_clock::now() - start);
+
+            simulator.dump(output_dir + "/resource-utilization");
+        } else if ("decoupled" == engine) {
+            // functional front-end & timing back-end on separate threads:
+            DecoupledSimulator simulator(text_segment, data_segment);
+            simulator.set_trace_sink(trace_sink.get());
+
+            const auto start = std::chrono::steady_clock::now();
+            simulator.run(mode, N);
+            report_throughput(simulator.get_total_instructions(), std::chrono::steady_clock::now() - start);
+
+            simulator.dump(output_dir + "/resource-utilization.json");
+        } else {
+            Executor executor(text_segment, data_segment);
+            executor.set_trace_sink(trace_sink.get());
+            executor.set_delay_slot(delay_slot);
+
+            std::unique_ptr<Profiler> profiler;
+            if (!profile.empty()) {
+                profiler.reset(new Profiler(text_segment));
+                executor.set_profiler(profiler.get());
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            executor.run(mode, N);
+            report_throughput(executor.get_total_instructions(), std::chrono::steady_clock::now() - start);
+
+            executor.dump(output_dir + "/resource-utilization.json");
+            if (profiler) {
+                profiler->dump(profile, executor.get_total_clock_cycles());
+            }
+        }
+
+        if (trace_sink) {
+            HOST_TIMER(TRACE_OUTPUT);
+            trace_sink->close();
+        }
 
-        executor.dump("../output/resource-utilization.json");
+        HostTimer::report(std::clog);
     }
     
     return 0;
@@ -0,0 +1,285 @@
+#include "packed_trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    /*
+        LEB128 varint of zigzag-mapped signed delta
+     */
+    void put_varint(std::string &output, std::uint32_t value) {
+        while (0x80 <= value) {
+            output.push_back(static_cast<char>(0x80 | (value & 0x7F)));
+            value >>= 7;
+        }
+        output.push_back(static_cast<char>(value));
+    }
+
+    // a 32-bit value takes at most 5 bytes:
+    const std::uint32_t MAX_VARINT_SHIFT = 28;
+
+    std::uint32_t get_varint(const unsigned char *&input, const unsigned char *end) {
+        std::uint32_t value = 0;
+
+        for (std::uint32_t shift = 0; shift <= MAX_VARINT_SHIFT; shift += 7) {
+            if (end == input) {
+                throw std::runtime_error("truncated record");
+            }
+
+            const unsigned char byte = *input++;
+            value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+            if (0 == (byte & 0x80)) {
+                return value;
+            }
+        }
+
+        throw std::runtime_error("varint longer than 5 bytes");
+    }
+
+    std::uint32_t zigzag(std::uint32_t delta) {
+        return (delta << 1) ^ static_cast<std::uint32_t>(static_cast<std::int32_t>(delta) >> 31);
+    }
+
+    std::uint32_t unzigzag(std::uint32_t value) {
+        return (value >> 1) ^ (0 - (value & 1));
+    }
+}
+
+PackedTraceWriter::PackedTraceWriter(
+    std::FILE *output,
+    const std::vector<PipelineTraceText> &text_table, const std::string &text_pool,
+    std::uint32_t block_records
+): BLOCK_RECORDS(block_records), writer(output), offset(0), closed(false), num_records(0) {
+    // a. header:
+    PackedTraceHeader header;
+    std::copy(PackedTrace::MAGIC, PackedTrace::MAGIC + sizeof(header.magic), header.magic);
+    header.version = PackedTrace::VERSION;
+    header.block_records = BLOCK_RECORDS;
+    header.num_instructions = text_table.size();
+    header.text_pool_size = text_pool.size();
+    emit(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    // b. text segment table & text pool:
+    emit(reinterpret_cast<const char *>(text_table.data()), text_table.size() * sizeof(PipelineTraceText));
+    emit(text_pool.data(), text_pool.size());
+
+    block_info.num_records = 0;
+}
+
+PackedTraceWriter::~PackedTraceWriter() {
+    close();
+}
+
+/**
+    Append one record.
+
+    @param snapshot pipeline state.
+*/
+void PackedTraceWriter::write(const PipelineSnapshot &snapshot) {
+    // start new block, encoded against an all-zero record:
+    if (0 == block_info.num_records) {
+        std::memset(&previous, 0, sizeof(previous));
+        block_info.first_cycle = snapshot.cycle;
+    }
+
+    put_varint(block, snapshot.cycle - previous.cycle);
+    for (std::size_t i = 0; i < PipelineSnapshot::NUM_STAGES; ++i) {
+        put_varint(block, zigzag(snapshot.pc[i] - previous.pc[i]));
+    }
+    block.push_back(static_cast<char>((snapshot.nop & 0x1F) | (snapshot.hazard << 5)));
+
+    previous = snapshot;
+    block_info.last_cycle = snapshot.cycle;
+    ++block_info.num_records;
+    ++num_records;
+
+    if (BLOCK_RECORDS == block_info.num_records) {
+        flush_block();
+    }
+}
+
+/**
+    Flush last block, write block index & footer.
+*/
+void PackedTraceWriter::close(void) {
+    if (closed) {
+        return;
+    }
+    closed = true;
+
+    flush_block();
+
+    PackedTraceFooter footer;
+    footer.num_blocks = index.size();
+    footer.num_records = num_records;
+    std::copy(PackedTrace::MAGIC, PackedTrace::MAGIC + sizeof(footer.magic), footer.magic);
+
+    // block index aligned for PackedTraceBlock, after variable-length blocks:
+    static const char PADDING[alignof(PackedTraceBlock)] = {};
+    emit(PADDING, (alignof(PackedTraceBlock) - offset % alignof(PackedTraceBlock)) % alignof(PackedTraceBlock));
+    footer.index_offset = offset;
+
+    emit(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(PackedTraceBlock));
+    emit(reinterpret_cast<const char *>(&footer), sizeof(footer));
+
+    writer.close();
+}
+
+void PackedTraceWriter::emit(const char *data, std::size_t size) {
+    writer.write(data, size);
+    offset += size;
+}
+
+void PackedTraceWriter::flush_block(void) {
+    if (0 == block_info.num_records) {
+        return;
+    }
+
+    block_info.offset = offset;
+    block_info.size = block.size();
+    index.push_back(block_info);
+
+    emit(block.data(), block.size());
+
+    block.clear();
+    block_info.num_records = 0;
+}
+
+PackedTraceReader::PackedTraceReader(const std::string &input_filename): file(input_filename) {
+    const char *data = file.data();
+
+    // a. validate header & footer:
+    header = reinterpret_cast<const PackedTraceHeader *>(data);
+    if (
+        file.size() < sizeof(PackedTraceHeader) + sizeof(PackedTraceFooter) ||
+        0 != std::memcmp(header->magic, PackedTrace::MAGIC, sizeof(PackedTrace::MAGIC)) ||
+        PackedTrace::VERSION != header->version
+    ) {
+        throw std::runtime_error("invalid packed trace file " + input_filename + " -- unsupported format");
+    }
+    std::memcpy(&footer, data + file.size() - sizeof(PackedTraceFooter), sizeof(PackedTraceFooter));
+    if (0 != std::memcmp(footer.magic, PackedTrace::MAGIC, sizeof(PackedTrace::MAGIC))) {
+        throw std::runtime_error("invalid packed trace file " + input_filename + " -- missing block index, was the trace closed?");
+    }
+
+    // b. locate sections:
+    const std::size_t text_table_offset = sizeof(PackedTraceHeader);
+    const std::size_t text_pool_offset = text_table_offset + std::size_t(header->num_instructions) * sizeof(PipelineTraceText);
+    const std::size_t blocks_offset = text_pool_offset + header->text_pool_size;
+    const std::size_t index_end = file.size() - sizeof(PackedTraceFooter);
+    if (
+        blocks_offset > footer.index_offset ||
+        footer.index_offset > index_end ||
+        0 != footer.index_offset % alignof(PackedTraceBlock) ||
+        0 != (index_end - footer.index_offset) % sizeof(PackedTraceBlock) ||
+        footer.num_blocks != (index_end - footer.index_offset) / sizeof(PackedTraceBlock)
+    ) {
+        throw std::runtime_error("invalid packed trace file " + input_filename + " -- corrupted block index");
+    }
+
+    text_table = reinterpret_cast<const PipelineTraceText *>(data + text_table_offset);
+    text_pool = data + text_pool_offset;
+    index = reinterpret_cast<const PackedTraceBlock *>(data + footer.index_offset);
+
+    // c. validate text references & blocks, which must lie between text pool & block index:
+    for (std::size_t i = 0; i < header->num_instructions; ++i) {
+        if (std::size_t(text_table[i].text_offset) + text_table[i].text_size > header->text_pool_size) {
+            throw std::runtime_error("invalid packed trace file " + input_filename + " -- corrupted text segment table");
+        }
+    }
+    std::uint64_t num_records = 0;
+    for (std::size_t i = 0; i < footer.num_blocks; ++i) {
+        if (
+            index[i].offset < blocks_offset || index[i].offset > footer.index_offset ||
+            index[i].size > footer.index_offset - index[i].offset
+        ) {
+            throw std::runtime_error("invalid packed trace file " + input_filename + " -- corrupted block index");
+        }
+        num_records += index[i].num_records;
+    }
+    // record count bounds readers that walk cycles, e.g. trace2text:
+    if (footer.num_records != num_records) {
+        throw std::runtime_error("invalid packed trace file " + input_filename + " -- corrupted record count");
+    }
+}
+
+/**
+    Decode one block.
+
+    @param i block index.
+    @param records output records, appended.
+*/
+void PackedTraceReader::decode_block(std::size_t i, std::vector<PipelineSnapshot> &records) const {
+    const PackedTraceBlock &block = index[i];
+    const unsigned char *input = reinterpret_cast<const unsigned char *>(file.data() + block.offset);
+    const unsigned char *end = input + block.size;
+
+    PipelineSnapshot snapshot;
+    std::memset(&snapshot, 0, sizeof(snapshot));
+
+    try {
+        for (std::uint32_t n = 0; n < block.num_records; ++n) {
+            snapshot.cycle += get_varint(input, end);
+            for (std::size_t j = 0; j < PipelineSnapshot::NUM_STAGES; ++j) {
+                snapshot.pc[j] += unzigzag(get_varint(input, end));
+            }
+            if (end == input) {
+                throw std::runtime_error("truncated record");
+            }
+            const unsigned char flags = *input++;
+            snapshot.nop = flags & 0x1F;
+            snapshot.hazard = flags >> 5;
+
+            records.push_back(snapshot);
+        }
+    } catch (const std::runtime_error &e) {
+        throw std::runtime_error("invalid packed trace -- corrupted block " + std::to_string(i) + ", " + e.what());
+    }
+}
+
+/**
+    Decode records of clock cycles [first_cycle, first_cycle + count), only touching the blocks involved.
+
+    @param first_cycle first clock cycle.
+    @param count number of clock cycles, 0 for all remaining.
+    @param records output records, appended.
+*/
+void PackedTraceReader::read(std::uint32_t first_cycle, std::size_t count, std::vector<PipelineSnapshot> &records) const {
+    const std::uint64_t last_cycle = (0 == count) ? UINT64_MAX : static_cast<std::uint64_t>(first_cycle) + count - 1;
+
+    // a. seek first block that may hold first_cycle:
+    const PackedTraceBlock *end = index + footer.num_blocks;
+    const PackedTraceBlock *block = std::lower_bound(
+        index, end, first_cycle,
+        [](const PackedTraceBlock &block, std::uint32_t cycle) {return block.last_cycle < cycle;}
+    );
+
+    // b. decode until last_cycle:
+    std::vector<PipelineSnapshot> decoded;
+    for (; end != block && block->first_cycle <= last_cycle; ++block) {
+        decoded.clear();
+        decode_block(block - index, decoded);
+
+        for (const auto &snapshot: decoded) {
+            if (first_cycle <= snapshot.cycle && snapshot.cycle <= last_cycle) {
+                records.push_back(snapshot);
+            }
+        }
+    }
+}
+
+/**
+    Get instruction source text, "nop" outside text segment.
+
+    @param address instruction address.
+*/
+std::string_view PackedTraceReader::get_text(ISA::Address address) const {
+    const PipelineTraceText *entry = PipelineTrace::find_text(text_table, header->num_instructions, address);
+
+    if (nullptr == entry) {
+        return "nop";
+    }
+
+    return std::string_view(text_pool + entry->text_offset, entry->text_size);
+}
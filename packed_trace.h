@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "isa.h"
+#include "async_writer.h"
+#include "pipeline_trace.h"
+
+/*
+    packed pipeline trace layout, all fields little-endian:
+
+        PackedTraceHeader
+        PipelineTraceText[num_instructions]     sorted by address
+        char[text_pool_size]                    instruction source text
+        block[num_blocks]                       independently decodable blocks of records
+        char[...]                               zero padding up to block index alignment
+        PackedTraceBlock[num_blocks]            block index
+        PackedTraceFooter
+
+    inside a block, each record is encoded against the previous one (the first against
+    an all-zero record) as varint cycle delta, 5 zigzag varint PC deltas, then one
+    byte holding stage bubble bits (low 5 bits) & hazard bits (high 3 bits).
+*/
+namespace PackedTrace {
+    const char MAGIC[8] = {'M', 'I', 'P', 'S', 'T', 'R', 'Z', '2'};
+    const std::uint32_t VERSION = 2;
+    const std::uint32_t DEFAULT_BLOCK_RECORDS = 4096;
+}
+
+struct PackedTraceHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t block_records;
+    std::uint32_t num_instructions;
+    std::uint32_t text_pool_size;
+};
+
+struct PackedTraceBlock {
+    std::uint64_t offset;
+    std::uint32_t size;
+    std::uint32_t num_records;
+    std::uint32_t first_cycle;
+    std::uint32_t last_cycle;
+};
+
+struct PackedTraceFooter {
+    std::uint64_t index_offset;
+    std::uint64_t num_blocks;
+    std::uint64_t num_records;
+    char magic[8];
+};
+
+/**
+ *  Streaming packed trace compressor.
+ */
+class PackedTraceWriter {
+public:
+    /**
+        @param output output stream, owned.
+        @param text_table text segment table, sorted by address.
+        @param text_pool instruction source text referenced by text_table.
+        @param block_records records per independently decodable block.
+    */
+    PackedTraceWriter(
+        std::FILE *output,
+        const std::vector<PipelineTraceText> &text_table, const std::string &text_pool,
+        std::uint32_t block_records = PackedTrace::DEFAULT_BLOCK_RECORDS
+    );
+    ~PackedTraceWriter();
+
+    /**
+        Append one record.
+
+        @param snapshot pipeline state.
+    */
+    void write(const PipelineSnapshot &snapshot);
+
+    /**
+        Flush last block, write block index & footer.
+    */
+    void close(void);
+private:
+    const std::uint32_t BLOCK_RECORDS;
+
+    AsyncWriter writer;
+    std::uint64_t offset;
+    bool closed;
+
+    // current block:
+    std::string block;
+    PackedTraceBlock block_info;
+    PipelineSnapshot previous;
+
+    std::vector<PackedTraceBlock> index;
+    std::uint64_t num_records;
+
+    void emit(const char *data, std::size_t size);
+    void flush_block(void);
+};
+
+/**
+ *  Memory-mapped packed trace reader with random access by clock cycle.
+ */
+class PackedTraceReader {
+public:
+    /**
+        @param input_filename input packed trace filename.
+    */
+    PackedTraceReader(const std::string &input_filename);
+
+    /**
+        Get number of recorded clock cycles & blocks.
+    */
+    std::size_t size(void) const {return footer.num_records;}
+    std::size_t get_num_blocks(void) const {return footer.num_blocks;}
+
+    /**
+        Decode one block.
+
+        @param i block index.
+        @param records output records, appended.
+    */
+    void decode_block(std::size_t i, std::vector<PipelineSnapshot> &records) const;
+
+    /**
+        Decode records of clock cycles [first_cycle, first_cycle + count), only touching the blocks involved.
+
+        @param first_cycle first clock cycle.
+        @param count number of clock cycles, 0 for all remaining.
+        @param records output records, appended.
+    */
+    void read(std::uint32_t first_cycle, std::size_t count, std::vector<PipelineSnapshot> &records) const;
+
+    /**
+        Get instruction source text, "nop" outside text segment.
+
+        @param address instruction address.
+    */
+    std::string_view get_text(ISA::Address address) const;
+private:
+    PipelineTrace::MappedFile file;
+
+    const PackedTraceHeader *header;
+    const PipelineTraceText *text_table;
+    const char *text_pool;
+    const PackedTraceBlock *index;
+    // copied, the footer ends the file at any alignment:
+    PackedTraceFooter footer;
+};
@@ -0,0 +1,139 @@
+#include "pipeline_trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+    Find instruction in text segment table.
+
+    @param table text segment table, sorted by address.
+    @param size number of entries.
+    @param address instruction address.
+    @return entry or nullptr outside text segment.
+*/
+const PipelineTraceText *PipelineTrace::find_text(const PipelineTraceText *table, std::size_t size, ISA::Address address) {
+    const PipelineTraceText *end = table + size;
+    const PipelineTraceText *entry = std::lower_bound(
+        table, end, address,
+        [](const PipelineTraceText &entry, ISA::Address address) {return entry.address < address;}
+    );
+
+    return (end != entry && address == entry->address) ? entry : nullptr;
+}
+
+/**
+    Get offset of first record, aligned for PipelineSnapshot.
+
+    @param num_instructions number of text segment table entries.
+    @param text_pool_size text pool size in bytes.
+*/
+std::size_t PipelineTrace::get_records_offset(std::size_t num_instructions, std::size_t text_pool_size) {
+    const std::size_t end = sizeof(PipelineTraceHeader) + num_instructions * sizeof(PipelineTraceText) + text_pool_size;
+
+    return (end + alignof(PipelineSnapshot) - 1) / alignof(PipelineSnapshot) * alignof(PipelineSnapshot);
+}
+
+PipelineTrace::MappedFile::MappedFile(const std::string &input_filename): begin(nullptr), length(0) {
+    int fd = open(input_filename.c_str(), O_RDONLY);
+    if (0 > fd) {
+        throw std::runtime_error("cannot open input trace file " + input_filename);
+    }
+
+    struct stat status;
+    if (0 != fstat(fd, &status)) {
+        close(fd);
+        throw std::runtime_error("cannot stat input trace file " + input_filename);
+    }
+    length = status.st_size;
+
+    if (0 < length) {
+        void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED == mapped) {
+            close(fd);
+            throw std::runtime_error("cannot map input trace file " + input_filename);
+        }
+        begin = static_cast<const char *>(mapped);
+    }
+
+    close(fd);
+}
+
+PipelineTrace::MappedFile::~MappedFile() {
+    if (nullptr != begin) {
+        munmap(const_cast<char *>(begin), length);
+    }
+}
+
+PipelineTraceReader::PipelineTraceReader(const std::string &input_filename): file(input_filename) {
+    const char *data = file.data();
+
+    // a. validate header:
+    header = reinterpret_cast<const PipelineTraceHeader *>(data);
+    if (
+        file.size() < sizeof(PipelineTraceHeader) ||
+        0 != std::memcmp(header->magic, PipelineTrace::MAGIC, sizeof(PipelineTrace::MAGIC)) ||
+        PipelineTrace::VERSION != header->version ||
+        sizeof(PipelineSnapshot) != header->record_size
+    ) {
+        throw std::runtime_error("invalid trace file " + input_filename + " -- unsupported format");
+    }
+
+    // b. locate sections:
+    const std::size_t text_table_offset = sizeof(PipelineTraceHeader);
+    const std::size_t text_pool_offset = text_table_offset + std::size_t(header->num_instructions) * sizeof(PipelineTraceText);
+    const std::size_t records_offset = PipelineTrace::get_records_offset(header->num_instructions, header->text_pool_size);
+    if (records_offset > file.size()) {
+        throw std::runtime_error("invalid trace file " + input_filename + " -- truncated text segment table");
+    }
+
+    text_table = reinterpret_cast<const PipelineTraceText *>(data + text_table_offset);
+    text_pool = data + text_pool_offset;
+    records = reinterpret_cast<const PipelineSnapshot *>(data + records_offset);
+    num_records = (file.size() - records_offset) / sizeof(PipelineSnapshot);
+
+    // c. validate text references:
+    for (std::size_t i = 0; i < header->num_instructions; ++i) {
+        if (std::size_t(text_table[i].text_offset) + text_table[i].text_size > header->text_pool_size) {
+            throw std::runtime_error("invalid trace file " + input_filename + " -- corrupted text segment table");
+        }
+    }
+}
+
+/**
+    Get index of first record at or after clock cycle.
+
+    @param cycle clock cycle.
+*/
+std::size_t PipelineTraceReader::find(std::uint32_t cycle) const {
+    return std::lower_bound(
+        records, records + num_records, cycle,
+        [](const PipelineSnapshot &record, std::uint32_t cycle) {return record.cycle < cycle;}
+    ) - records;
+}
+
+/**
+    Get instruction source text, "nop" outside text segment.
+
+    @param address instruction address.
+*/
+std::string_view PipelineTraceReader::get_text(ISA::Address address) const {
+    const PipelineTraceText *entry = PipelineTrace::find_text(text_table, header->num_instructions, address);
+
+    if (nullptr == entry) {
+        return "nop";
+    }
+
+    return std::string_view(text_pool + entry->text_offset, entry->text_size);
+}
+
+ISA::MachineCode PipelineTraceReader::get_binary(ISA::Address address) const {
+    const PipelineTraceText *entry = PipelineTrace::find_text(text_table, header->num_instructions, address);
+
+    return (nullptr == entry) ? 0x00000000 : entry->binary;
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <charconv>
+#include <cinttypes>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "isa.h"
+
+/*
+    binary pipeline trace layout, all fields little-endian:
+
+        PipelineTraceHeader
+        PipelineTraceText[num_instructions]     sorted by address
+        char[text_pool_size]                    instruction source text
+        char[...]                               zero padding up to record alignment
+        PipelineSnapshot[...]                   one per clock cycle until end of file
+*/
+namespace PipelineTrace {
+    const char MAGIC[8] = {'M', 'I', 'P', 'S', 'T', 'R', 'C', '3'};
+    const std::uint32_t VERSION = 3;
+
+    /*
+        stage bits in PipelineSnapshot::nop
+     */
+    enum Stage {
+        IF = 0,
+        ID = 1,
+        EX = 2,
+        MEM = 3,
+        WB = 4,
+        NUM_STAGES = 5
+    };
+
+    /*
+        hazard bits in PipelineSnapshot::hazard
+     */
+    enum Hazard {
+        DATA = 0x01,
+        CONTROL = 0x02,
+        STRUCTURAL = 0x04
+    };
+}
+
+struct PipelineTraceHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint32_t num_instructions;
+    std::uint32_t text_pool_size;
+};
+
+struct PipelineTraceText {
+    ISA::Address address;
+    ISA::MachineCode binary;
+    std::uint32_t text_offset;
+    std::uint32_t text_size;
+};
+
+/**
+ *  Pipeline state at the beginning of one clock cycle, also the fixed-size binary trace record.
+ */
+struct PipelineSnapshot {
+    static const std::size_t NUM_STAGES = PipelineTrace::NUM_STAGES;
+
+    std::uint32_t cycle;
+    // next fetch PC for IF, instruction addresses for ID, EX, MEM & WB:
+    ISA::Address pc[NUM_STAGES];
+    // bit i set if stage i holds a bubble:
+    std::uint8_t nop;
+    // PipelineTrace::Hazard bits:
+    std::uint8_t hazard;
+    std::uint16_t reserved;
+};
+static_assert(28 == sizeof(PipelineSnapshot), "PipelineSnapshot must stay packed, it is the binary trace record");
+
+namespace PipelineTrace {
+    /**
+        Render one snapshot in system state plot text format, without allocation once output has grown.
+
+        @param output output text, appended.
+        @param snapshot pipeline state.
+        @param lookup anything with get_text(ISA::Address) returning std::string_view, e.g. TextSegment or PipelineTraceReader.
+    */
+    template <typename TextLookup>
+    void render(std::string &output, const PipelineSnapshot &snapshot, TextLookup &lookup) {
+        static const char *STAGE_PREFIX[NUM_STAGES] = {"\tIF: ", "\tID: ", "\tEX: ", "\tMEM: ", "\tWB: "};
+
+        // clock cycle:
+        output.append("[Clock Cycle]: ");
+        char cycle[16];
+        output.append(cycle, std::to_chars(cycle, cycle + sizeof(cycle), snapshot.cycle).ptr);
+        output.push_back('\n');
+        // pipeline state:
+        for (std::size_t i = 0; i < NUM_STAGES; ++i) {
+            output.append(STAGE_PREFIX[i]);
+            output.append(lookup.get_text(snapshot.pc[i]));
+            output.push_back('\n');
+        }
+        output.push_back('\n');
+    }
+
+    /**
+        Find instruction in text segment table.
+
+        @param table text segment table, sorted by address.
+        @param size number of entries.
+        @param address instruction address.
+        @return entry or nullptr outside text segment.
+    */
+    const PipelineTraceText *find_text(const PipelineTraceText *table, std::size_t size, ISA::Address address);
+
+    /**
+        Get offset of first record, aligned for PipelineSnapshot.
+
+        @param num_instructions number of text segment table entries.
+        @param text_pool_size text pool size in bytes.
+    */
+    std::size_t get_records_offset(std::size_t num_instructions, std::size_t text_pool_size);
+
+    /**
+     *  Read-only memory-mapped file.
+     */
+    class MappedFile {
+    public:
+        /**
+            @param input_filename input filename.
+        */
+        MappedFile(const std::string &input_filename);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const char *data(void) const {return begin;}
+        std::size_t size(void) const {return length;}
+    private:
+        const char *begin;
+        std::size_t length;
+    };
+}
+
+/**
+ *  Memory-mapped binary pipeline trace reader.
+ */
+class PipelineTraceReader {
+public:
+    /**
+        @param input_filename input binary trace filename.
+    */
+    PipelineTraceReader(const std::string &input_filename);
+
+    /**
+        Get number of recorded clock cycles.
+    */
+    std::size_t size(void) const {return num_records;}
+
+    /**
+        Get pipeline state of i-th recorded clock cycle.
+
+        @param i record index.
+    */
+    const PipelineSnapshot &get(std::size_t i) const {return records[i];}
+
+    /**
+        Get index of first record at or after clock cycle.
+
+        @param cycle clock cycle.
+    */
+    std::size_t find(std::uint32_t cycle) const;
+
+    /**
+        Get instruction source text, "nop" outside text segment.
+
+        @param address instruction address.
+    */
+    std::string_view get_text(ISA::Address address) const;
+    ISA::MachineCode get_binary(ISA::Address address) const;
+
+    /**
+        Get text segment table.
+    */
+    const PipelineTraceText *get_text_table(void) const {return text_table;}
+    std::size_t get_num_instructions(void) const {return header->num_instructions;}
+    std::string get_text_pool(void) const {return std::string(text_pool, header->text_pool_size);}
+private:
+    PipelineTrace::MappedFile file;
+
+    const PipelineTraceHeader *header;
+    const PipelineTraceText *text_table;
+    const char *text_pool;
+    const PipelineSnapshot *records;
+    std::size_t num_records;
+};
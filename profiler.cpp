@@ -0,0 +1,103 @@
+#include "profiler.h"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+
+#include "host_timer.h"
+
+namespace {
+    // number of instructions listed as hot spots:
+    const std::size_t NUM_HOT_SPOTS = 10;
+}
+
+Profiler::Profiler(ISA::TextSegment &text): TEXT_SEGMENT_BEGIN(text.get_address_first()), text_segment(text) {
+    entries.resize(((text.get_address_last() - TEXT_SEGMENT_BEGIN) >> 2) + 1);
+
+    reset();
+}
+
+/**
+    Reset all counters.
+*/
+void Profiler::reset(void) {
+    std::memset(entries.data(), 0, entries.size() * sizeof(Entry));
+}
+
+/**
+    Dump annotated instruction image, in address order followed by hot spots in cycle order.
+
+    @param output_filename output filename.
+    @param total_clock_cycles total number of clock cycles of profiled run.
+*/
+void Profiler::dump(const std::string &output_filename, std::uint64_t total_clock_cycles) {
+    HOST_TIMER(REPORT_DUMP);
+
+    std::ofstream output(output_filename);
+
+    if (!output) {
+        std::cerr << "[MIPS simulator]: ERROR -- cannot open output profile file "<< output_filename <<std::endl;
+        return;
+    }
+
+    // share of clock cycles: cycles spent holding the ID slot, stalls included, so that shares sum to at most 100%:
+    auto share = [total_clock_cycles](const Entry &entry) {
+        return (0 == total_clock_cycles) ? 0.0 : (100.0 * entry.cycles[Stage::ID]) / total_clock_cycles;
+    };
+
+    auto annotate = [this, &output, &share](std::size_t i) {
+        const ISA::Address address = TEXT_SEGMENT_BEGIN + (i << 2);
+        const Entry &entry = entries[i];
+
+        output << "0x" << std::setfill('0') << std::setw(8) << std::hex << address;
+        output << ": ";
+        output << "0x" << std::setfill('0') << std::setw(8) << std::hex << text_segment.get_binary(address);
+        output << ";" << std::setfill(' ') << std::dec;
+        output << std::setw(10) << entry.count;
+        for (std::size_t stage = 0; stage < Stage::NUM_STAGES; ++stage) {
+            output << std::setw(10) << entry.cycles[stage];
+        }
+        output << std::setw(10) << entry.stalled << std::setw(10) << entry.caused;
+        output << std::setw(9) << std::fixed << std::setprecision(2) << share(entry) << "%";
+        output << "\t" << text_segment.get_text(address);
+        output << std::endl;
+    };
+
+    auto header = [&output]() {
+        static const char *COLUMN[] = {"count", "IF", "ID", "EX", "MEM", "WB", "stalled", "caused"};
+
+        output << std::setfill(' ') << std::left << std::setw(23) << "# address: machine code" << std::right;
+        for (const char *column: COLUMN) {
+            output << std::setw(10) << column;
+        }
+        output << std::setw(10) << "cycles" << "\tsource" << std::endl;
+    };
+
+    // a. annotated instruction image:
+    output << "# total clock cycles: " << total_clock_cycles << std::endl;
+    header();
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        annotate(i);
+    }
+
+    // b. hot spots:
+    std::vector<std::size_t> order(entries.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(
+        order.begin(), order.end(),
+        [this](std::size_t a, std::size_t b) {return entries[a].cycles[Stage::ID] > entries[b].cycles[Stage::ID];}
+    );
+
+    output << std::endl << "# hot spots" << std::endl;
+    header();
+    for (std::size_t i = 0; i < std::min(NUM_HOT_SPOTS, order.size()) && 0 != entries[order[i]].count; ++i) {
+        annotate(order[i]);
+    }
+
+    // close output file:
+    output.close();
+}
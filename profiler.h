@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "isa.h"
+
+/**
+ *  Per-PC hot-spot profiler -- execution count, clock cycles spent in each stage &
+ *  stall cycles for every instruction in text segment.
+ */
+class Profiler {
+public:
+    enum Stage {
+        IF = 0,
+        ID = 1,
+        EX = 2,
+        MEM = 3,
+        WB = 4,
+        NUM_STAGES = 5
+    };
+
+    /**
+        @param text profiled text segment.
+    */
+    Profiler(ISA::TextSegment &text);
+
+    /**
+        Record fetched instruction.
+
+        @param address instruction address.
+    */
+    void fetch(ISA::Address address) {
+        if (Entry *entry = find(address)) {
+            ++entry->count;
+        }
+    }
+    /**
+        Record one clock cycle spent by instruction inside stage.
+
+        @param stage pipeline stage.
+        @param address instruction address.
+    */
+    void occupy(Stage stage, ISA::Address address) {
+        if (Entry *entry = find(address)) {
+            ++entry->cycles[stage];
+        }
+    }
+    /**
+        Record one bubble -- instruction held in ID waiting for operands, and the one it waits for or the branch blocking fetch.
+
+        @param address instruction address.
+    */
+    void stall(ISA::Address address) {
+        if (Entry *entry = find(address)) {
+            ++entry->stalled;
+        }
+    }
+    void cause(ISA::Address address) {
+        if (Entry *entry = find(address)) {
+            ++entry->caused;
+        }
+    }
+
+    /**
+        Reset all counters.
+    */
+    void reset(void);
+
+    /**
+        Dump annotated instruction image, in address order followed by hot spots in cycle order.
+
+        @param output_filename output filename.
+        @param total_clock_cycles total number of clock cycles of profiled run.
+    */
+    void dump(const std::string &output_filename, std::uint64_t total_clock_cycles);
+private:
+    struct Entry {
+        std::uint64_t count;
+        std::uint64_t cycles[NUM_STAGES];
+        std::uint64_t stalled;
+        std::uint64_t caused;
+    };
+
+    const ISA::Address TEXT_SEGMENT_BEGIN;
+    std::vector<Entry> entries;
+
+    ISA::TextSegment &text_segment;
+
+    Entry *find(ISA::Address address) {
+        const std::size_t i = (address - TEXT_SEGMENT_BEGIN) >> 2;
+
+        return (address >= TEXT_SEGMENT_BEGIN && i < entries.size()) ? &entries[i] : nullptr;
+    }
+};
@@ -0,0 +1,276 @@
+#include "program_image.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+/**
+    Check whether file starts with program image magic.
+
+    @param filename input filename.
+*/
+bool ProgramImage::is_image(const std::string &filename) {
+    std::ifstream input(filename, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+
+    return input.read(magic, sizeof(magic)) && 0 == std::memcmp(magic, MAGIC, sizeof(MAGIC));
+}
+
+/**
+    Write program image.
+
+    @param output_filename output filename.
+    @param text text segment.
+    @param lines source line of each instruction, in address order.
+    @param symbols label to instruction address.
+    @param data initial data segment words.
+*/
+void ProgramImage::write(
+    const std::string &output_filename,
+    ISA::TextSegment &text,
+    const std::vector<std::uint32_t> &lines,
+    const std::unordered_map<std::string, ISA::Address> &symbols,
+    const DataWords &data
+) {
+    const ISA::Address FIRST = text.get_address_first();
+    const std::size_t N = ((text.get_address_last() - FIRST) >> 2) + 1;
+
+    ProgramImageWriter writer(output_filename, N, symbols, data);
+    for (std::size_t i = 0; i < N; ++i) {
+        const ISA::Address address = FIRST + (i << 2);
+        writer.append(address, text.get_binary(address), (i < lines.size()) ? lines[i] : 0, text.get_text(address));
+    }
+    writer.close();
+}
+
+ProgramImageWriter::ProgramImageWriter(
+    const std::string &output_filename,
+    std::size_t num_instructions,
+    const std::unordered_map<std::string, ISA::Address> &symbols,
+    const ProgramImage::DataWords &data
+):
+    OUTPUT_FILENAME(output_filename),
+    TEMPORARY_FILENAME(output_filename + ".tmp." + std::to_string(getpid())),
+    output(TEMPORARY_FILENAME, std::ios::binary),
+    num_appended(0) {
+    if (!output) {
+        throw std::runtime_error("cannot open output program image file " + OUTPUT_FILENAME);
+    }
+
+    // a. data segment, sorted by address:
+    std::vector<ProgramImageWord> data_words;
+    for (const auto &word: data) {
+        data_words.push_back({word.first, word.second});
+    }
+    std::sort(
+        data_words.begin(), data_words.end(),
+        [](const ProgramImageWord &a, const ProgramImageWord &b) {return a.address < b.address;}
+    );
+
+    // b. symbol table, sorted by address, names leading the string pool:
+    std::vector<std::pair<ISA::Address, std::string>> ordered;
+    for (const auto &symbol: symbols) {
+        ordered.push_back({symbol.second, symbol.first});
+    }
+    std::sort(ordered.begin(), ordered.end());
+
+    std::vector<ProgramImageSymbol> symbol_table;
+    std::string names;
+    for (const auto &symbol: ordered) {
+        symbol_table.push_back({symbol.first, static_cast<std::uint32_t>(names.size()), static_cast<std::uint32_t>(symbol.second.size())});
+        names.append(symbol.second);
+    }
+
+    // c. header, string pool size completed on close:
+    std::memcpy(header.magic, ProgramImage::MAGIC, sizeof(ProgramImage::MAGIC));
+    header.version = ProgramImage::VERSION;
+    header.num_instructions = num_instructions;
+    header.num_data_words = data_words.size();
+    header.num_symbols = symbol_table.size();
+    header.string_pool_size = names.size();
+
+    // d. fixed-size sections behind text & line tables:
+    text_table_offset = sizeof(ProgramImageHeader);
+    line_table_offset = text_table_offset + std::uint64_t(num_instructions) * sizeof(PipelineTraceText);
+    output.seekp(line_table_offset + std::uint64_t(num_instructions) * sizeof(std::uint32_t));
+    output.write(reinterpret_cast<const char *>(data_words.data()), data_words.size() * sizeof(ProgramImageWord));
+    output.write(reinterpret_cast<const char *>(symbol_table.data()), symbol_table.size() * sizeof(ProgramImageSymbol));
+    output.write(names.data(), names.size());
+    string_pool_offset = output.tellp();
+
+    const std::size_t block_size = BLOCK_SIZE;
+    text_block.reserve(std::min(num_instructions, block_size));
+    line_block.reserve(std::min(num_instructions, block_size));
+}
+
+ProgramImageWriter::~ProgramImageWriter() {
+    // unpublished image:
+    if (output.is_open()) {
+        output.close();
+        std::remove(TEMPORARY_FILENAME.c_str());
+    }
+}
+
+/**
+    Append next instruction.
+
+    @param address instruction address.
+    @param binary instruction machine code.
+    @param line source line, 0 if unknown.
+    @param text source text, empty to omit.
+*/
+void ProgramImageWriter::append(ISA::Address address, ISA::MachineCode binary, std::uint32_t line, std::string_view text) {
+    if (header.num_instructions <= num_appended) {
+        throw std::runtime_error("too many instructions for output program image file " + OUTPUT_FILENAME);
+    }
+
+    text_block.push_back({address, binary, static_cast<std::uint32_t>(header.string_pool_size), static_cast<std::uint32_t>(text.size())});
+    line_block.push_back(line);
+    string_block.append(text);
+    header.string_pool_size += text.size();
+    ++num_appended;
+
+    if (BLOCK_SIZE == text_block.size()) {
+        flush();
+    }
+}
+
+/**
+    Write buffered block to text table, line table & string pool.
+*/
+void ProgramImageWriter::flush(void) {
+    output.seekp(text_table_offset);
+    output.write(reinterpret_cast<const char *>(text_block.data()), text_block.size() * sizeof(PipelineTraceText));
+    output.seekp(line_table_offset);
+    output.write(reinterpret_cast<const char *>(line_block.data()), line_block.size() * sizeof(std::uint32_t));
+    output.seekp(string_pool_offset);
+    output.write(string_block.data(), string_block.size());
+
+    text_table_offset += text_block.size() * sizeof(PipelineTraceText);
+    line_table_offset += line_block.size() * sizeof(std::uint32_t);
+    string_pool_offset += string_block.size();
+
+    text_block.clear();
+    line_block.clear();
+    string_block.clear();
+}
+
+/**
+    Flush remaining instructions & publish image by rename, so readers never see a partial image.
+*/
+void ProgramImageWriter::close(void) {
+    flush();
+
+    if (header.num_instructions != num_appended) {
+        throw std::runtime_error("missing instructions for output program image file " + OUTPUT_FILENAME);
+    }
+
+    output.seekp(0);
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    output.close();
+
+    if (!output || 0 != std::rename(TEMPORARY_FILENAME.c_str(), OUTPUT_FILENAME.c_str())) {
+        std::remove(TEMPORARY_FILENAME.c_str());
+        throw std::runtime_error("cannot write output program image file " + OUTPUT_FILENAME);
+    }
+}
+
+ProgramImageReader::ProgramImageReader(const std::string &input_filename): file(input_filename) {
+    const char *data = file.data();
+
+    // a. validate header:
+    header = reinterpret_cast<const ProgramImageHeader *>(data);
+    if (
+        file.size() < sizeof(ProgramImageHeader) ||
+        0 != std::memcmp(header->magic, ProgramImage::MAGIC, sizeof(ProgramImage::MAGIC)) ||
+        ProgramImage::VERSION != header->version
+    ) {
+        throw std::runtime_error("invalid program image " + input_filename + " -- unsupported format");
+    }
+
+    // b. locate sections:
+    const std::size_t text_table_offset = sizeof(ProgramImageHeader);
+    const std::size_t line_table_offset = text_table_offset + std::size_t(header->num_instructions) * sizeof(PipelineTraceText);
+    const std::size_t data_words_offset = line_table_offset + std::size_t(header->num_instructions) * sizeof(std::uint32_t);
+    const std::size_t symbol_table_offset = data_words_offset + std::size_t(header->num_data_words) * sizeof(ProgramImageWord);
+    const std::size_t string_pool_offset = symbol_table_offset + std::size_t(header->num_symbols) * sizeof(ProgramImageSymbol);
+    if (0 == header->num_instructions || string_pool_offset + header->string_pool_size != file.size()) {
+        throw std::runtime_error("invalid program image " + input_filename + " -- truncated");
+    }
+
+    text_table = reinterpret_cast<const PipelineTraceText *>(data + text_table_offset);
+    line_table = reinterpret_cast<const std::uint32_t *>(data + line_table_offset);
+    data_words = reinterpret_cast<const ProgramImageWord *>(data + data_words_offset);
+    symbol_table = reinterpret_cast<const ProgramImageSymbol *>(data + symbol_table_offset);
+    string_pool = data + string_pool_offset;
+
+    // c. validate string references:
+    for (std::size_t i = 0; i < header->num_instructions; ++i) {
+        if (std::size_t(text_table[i].text_offset) + text_table[i].text_size > header->string_pool_size) {
+            throw std::runtime_error("invalid program image " + input_filename + " -- corrupted text table");
+        }
+    }
+    for (std::size_t i = 0; i < header->num_symbols; ++i) {
+        if (std::size_t(symbol_table[i].name_offset) + symbol_table[i].name_size > header->string_pool_size) {
+            throw std::runtime_error("invalid program image " + input_filename + " -- corrupted symbol table");
+        }
+    }
+}
+
+/**
+    Build text segment, without assembly.
+
+    @param with_text false to leave source text out, instructions are then rendered by the disassembler.
+*/
+ISA::TextSegment ProgramImageReader::get_text_segment(bool with_text) const {
+    ISA::TextSegment text_segment;
+
+    for (std::size_t i = 0; i < header->num_instructions; ++i) {
+        const PipelineTraceText &entry = text_table[i];
+        text_segment.set(entry.address, entry.binary, with_text ? std::string_view(string_pool + entry.text_offset, entry.text_size) : std::string_view());
+    }
+
+    return text_segment;
+}
+
+/**
+    Get initial data segment words.
+*/
+ProgramImage::DataWords ProgramImageReader::get_data(void) const {
+    ProgramImage::DataWords data;
+
+    for (std::size_t i = 0; i < header->num_data_words; ++i) {
+        data.push_back({data_words[i].address, data_words[i].word});
+    }
+
+    return data;
+}
+
+/**
+    Get symbol table, label to instruction address.
+*/
+std::unordered_map<std::string, ISA::Address> ProgramImageReader::get_symbols(void) const {
+    std::unordered_map<std::string, ISA::Address> symbols;
+
+    for (std::size_t i = 0; i < header->num_symbols; ++i) {
+        const ProgramImageSymbol &symbol = symbol_table[i];
+        symbols.insert({std::string(string_pool + symbol.name_offset, symbol.name_size), symbol.address});
+    }
+
+    return symbols;
+}
+
+/**
+    Get source line of instruction, 0 if unknown.
+
+    @param address instruction address.
+*/
+std::uint32_t ProgramImageReader::get_line(ISA::Address address) const {
+    const PipelineTraceText *entry = PipelineTrace::find_text(text_table, header->num_instructions, address);
+
+    return (nullptr == entry) ? 0 : line_table[entry - text_table];
+}
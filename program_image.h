@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cinttypes>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+#include "isa.h"
+#include "pipeline_trace.h"
+
+/*
+    binary program image layout, all fields little-endian:
+
+        ProgramImageHeader
+        PipelineTraceText[num_instructions]     text segment, sorted by address
+        std::uint32_t[num_instructions]         line table, source line of each instruction, 0 if unknown
+        ProgramImageWord[num_data_words]        initial data segment, sorted by address
+        ProgramImageSymbol[num_symbols]         symbol table, sorted by address
+        char[string_pool_size]                  instruction source text & symbol names
+*/
+namespace ProgramImage {
+    const char MAGIC[8] = {'M', 'I', 'P', 'S', 'I', 'M', 'G', '1'};
+    const std::uint32_t VERSION = 1;
+
+    typedef std::vector<std::pair<ISA::Address, ISA::Word>> DataWords;
+
+    /**
+        Check whether file starts with program image magic.
+
+        @param filename input filename.
+    */
+    bool is_image(const std::string &filename);
+
+    /**
+        Write program image.
+
+        @param output_filename output filename.
+        @param text text segment.
+        @param lines source line of each instruction, in address order.
+        @param symbols label to instruction address.
+        @param data initial data segment words.
+    */
+    void write(
+        const std::string &output_filename,
+        ISA::TextSegment &text,
+        const std::vector<std::uint32_t> &lines,
+        const std::unordered_map<std::string, ISA::Address> &symbols,
+        const DataWords &data = DataWords()
+    );
+}
+
+struct ProgramImageHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t num_instructions;
+    std::uint32_t num_data_words;
+    std::uint32_t num_symbols;
+    std::uint32_t string_pool_size;
+};
+
+struct ProgramImageWord {
+    ISA::Address address;
+    ISA::Word word;
+};
+
+struct ProgramImageSymbol {
+    ISA::Address address;
+    std::uint32_t name_offset;
+    std::uint32_t name_size;
+};
+
+/**
+ *  Binary program image writer, instructions appended in address order through a bounded block buffer.
+ */
+class ProgramImageWriter {
+public:
+    /**
+        @param output_filename output program image filename, published on close.
+        @param num_instructions number of instructions to be appended.
+        @param symbols label to instruction address.
+        @param data initial data segment words.
+    */
+    ProgramImageWriter(
+        const std::string &output_filename,
+        std::size_t num_instructions,
+        const std::unordered_map<std::string, ISA::Address> &symbols,
+        const ProgramImage::DataWords &data = ProgramImage::DataWords()
+    );
+    ~ProgramImageWriter();
+
+    ProgramImageWriter(const ProgramImageWriter &) = delete;
+    ProgramImageWriter &operator=(const ProgramImageWriter &) = delete;
+
+    /**
+        Append next instruction.
+
+        @param address instruction address.
+        @param binary instruction machine code.
+        @param line source line, 0 if unknown.
+        @param text source text, empty to omit.
+    */
+    void append(ISA::Address address, ISA::MachineCode binary, std::uint32_t line, std::string_view text = std::string_view());
+
+    /**
+        Flush remaining instructions & publish image by rename, so readers never see a partial image.
+    */
+    void close(void);
+private:
+    // instructions buffered before each write:
+    static const std::size_t BLOCK_SIZE = 65536;
+
+    const std::string OUTPUT_FILENAME;
+    const std::string TEMPORARY_FILENAME;
+    std::ofstream output;
+    ProgramImageHeader header;
+
+    // file offsets of next text table entry, line table entry & string pool byte:
+    std::uint64_t text_table_offset;
+    std::uint64_t line_table_offset;
+    std::uint64_t string_pool_offset;
+    std::size_t num_appended;
+
+    std::vector<PipelineTraceText> text_block;
+    std::vector<std::uint32_t> line_block;
+    std::string string_block;
+
+    void flush(void);
+};
+
+/**
+ *  Memory-mapped binary program image reader.
+ */
+class ProgramImageReader {
+public:
+    /**
+        @param input_filename input program image filename.
+    */
+    ProgramImageReader(const std::string &input_filename);
+
+    std::size_t get_num_instructions(void) const {return header->num_instructions;}
+
+    /**
+        Build text segment, without assembly.
+
+        @param with_text false to leave source text out, instructions are then rendered by the disassembler.
+    */
+    ISA::TextSegment get_text_segment(bool with_text = true) const;
+
+    /**
+        Get initial data segment words.
+    */
+    ProgramImage::DataWords get_data(void) const;
+
+    /**
+        Get symbol table, label to instruction address.
+    */
+    std::unordered_map<std::string, ISA::Address> get_symbols(void) const;
+
+    /**
+        Get source line of instruction, 0 if unknown.
+
+        @param address instruction address.
+    */
+    std::uint32_t get_line(ISA::Address address) const;
+private:
+    PipelineTrace::MappedFile file;
+
+    const ProgramImageHeader *header;
+    const PipelineTraceText *text_table;
+    const std::uint32_t *line_table;
+    const ProgramImageWord *data_words;
+    const ProgramImageSymbol *symbol_table;
+    const char *string_pool;
+};
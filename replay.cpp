@@ -0,0 +1,115 @@
+#include "replay.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "json.h"
+
+TraceReplay::TraceReplay(const DynamicTraceReader &trace, const std::vector<TimingConfig> &configs): trace(trace) {
+    for (const auto &config: configs) {
+        results.push_back(
+            {
+                config,
+                Cache(config.dcache_size, config.dcache_line_size, config.dcache_ways),
+                BranchPredictor(config.branch_policy, config.predictor_entries),
+                0.0
+            }
+        );
+    }
+}
+
+/**
+    Replay trace through all configurations.
+
+    @param jobs number of worker threads, 0 for one per hardware thread.
+*/
+void TraceReplay::run(std::size_t jobs) {
+    if (0 == jobs) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    jobs = std::min(jobs, results.size());
+
+    // workers pull configurations until none is left:
+    std::atomic<std::size_t> next(0);
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < jobs; ++i) {
+        workers.emplace_back(
+            [this, &next]() {
+                for (std::size_t j = next++; j < results.size(); j = next++) {
+                    replay(results[j]);
+                }
+            }
+        );
+    }
+
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+void TraceReplay::replay(Result &result) {
+    const auto start = std::chrono::steady_clock::now();
+
+    result.dcache.reset();
+    result.predictor.reset();
+
+    for (const DynamicTraceRecord *record = trace.begin(); trace.end() != record; ++record) {
+        // a. memory access:
+        if (record->flags & (DynamicTrace::LOAD | DynamicTrace::STORE)) {
+            result.dcache.access(record->mem_address);
+        }
+        // b. branch outcome:
+        if (record->flags & DynamicTrace::BRANCH) {
+            result.predictor.predict(record->pc, 0 != (record->flags & DynamicTrace::TAKEN));
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+    Dump one replay report per configuration, named
+    [output_prefix]--[configuration name].json
+
+    @param output_prefix output filename prefix.
+*/
+void TraceReplay::dump(const std::string &output_prefix) {
+    for (const auto &result: results) {
+        const std::string output_filename = output_prefix + "--" + result.config.name + ".json";
+        std::ofstream output(output_filename);
+
+        if(!output) {
+            std::cerr << "[MIPS simulator]: ERROR -- cannot open output replay report file "<< output_filename <<std::endl;
+            continue;
+        }
+
+        const std::uint64_t accesses = result.dcache.get_accesses() + result.predictor.get_branches();
+
+        nlohmann::json replay_report;
+
+        replay_report["configuration"] = result.config.to_json();
+        replay_report["total instructions"] = trace.size();
+        replay_report["data cache"] = {
+            {"accesses", result.dcache.get_accesses()},
+            {"misses", result.dcache.get_misses()},
+            {"miss rate", (0 == result.dcache.get_accesses()) ? 0.0 : (100.0 * result.dcache.get_misses()) / result.dcache.get_accesses()}
+        };
+        replay_report["branch predictor"] = {
+            {"branches", result.predictor.get_branches()},
+            {"mispredictions", result.predictor.get_mispredictions()}
+        };
+        replay_report["host"] = {
+            {"seconds", result.seconds},
+            {"accesses per second", (0.0 == result.seconds) ? 0.0 : accesses / result.seconds}
+        };
+
+        output << replay_report.dump(4) << std::endl;
+
+        // close output file:
+        output.close();
+    }
+}
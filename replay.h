@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "dynamic_trace.h"
+#include "cache.h"
+#include "branch_predictor.h"
+#include "timing.h"
+
+/**
+ *  Trace-driven replay -- drives data cache & branch predictor models straight from a
+ *  recorded dynamic instruction trace, without re-executing the program.
+ *  Each configuration replays the shared memory-mapped trace on its own thread.
+ */
+class TraceReplay {
+public:
+    /**
+        @param trace recorded dynamic instruction trace.
+        @param configs timing configurations, only data cache & branch predictor settings are used.
+    */
+    TraceReplay(const DynamicTraceReader &trace, const std::vector<TimingConfig> &configs);
+
+    /**
+        Replay trace through all configurations.
+
+        @param jobs number of worker threads, 0 for one per hardware thread.
+    */
+    void run(std::size_t jobs = 0);
+
+    /**
+        Dump one replay report per configuration, named
+        [output_prefix]--[configuration name].json
+
+        @param output_prefix output filename prefix.
+    */
+    void dump(const std::string &output_prefix);
+private:
+    struct Result {
+        TimingConfig config;
+        Cache dcache;
+        BranchPredictor predictor;
+        // host time spent replaying, in seconds:
+        double seconds;
+    };
+
+    const DynamicTraceReader &trace;
+    std::vector<Result> results;
+
+    void replay(Result &result);
+};
@@ -0,0 +1,652 @@
+#include "scheduler.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+    // HI/LO pair written by mult, beside the 32 general purpose registers:
+    const std::uint64_t HI_LO = std::uint64_t(1) << 32;
+    // $zero is never written & never causes a hazard:
+    const std::uint64_t ZERO = 1;
+
+    ISA::Word get_opcode(ISA::MachineCode machine_code) {
+        return ISA::get_instruction_field(machine_code, ISA::Field::OPCODE);
+    }
+
+    bool is_branch(ISA::MachineCode machine_code) {
+        return ISA::OpCode::BEQ == get_opcode(machine_code);
+    }
+
+    /**
+        Get destination register carried by EX_MEM, set at ID -- rd for R-type, rt for all others.
+
+        @param machine_code producer machine code.
+    */
+    ISA::Word get_ex_write(ISA::MachineCode machine_code) {
+        return ISA::get_instruction_field(
+            machine_code,
+            (ISA::OpCode::R_COMMON == get_opcode(machine_code)) ? ISA::Field::RD : ISA::Field::RT
+        );
+    }
+
+    /**
+        Get destination register carried by MEM_WB, cleared at MEM for stores, branches & unknown opcodes.
+
+        @param machine_code producer machine code.
+    */
+    ISA::Word get_mem_write(ISA::MachineCode machine_code) {
+        switch (get_opcode(machine_code)) {
+            case ISA::OpCode::R_COMMON:
+            case ISA::OpCode::ADDI:
+            case ISA::OpCode::ANDI:
+            case ISA::OpCode::ORI:
+            case ISA::OpCode::SLTI:
+            case ISA::OpCode::SLTIU:
+            case ISA::OpCode::LUI:
+            case ISA::OpCode::LW:
+                return get_ex_write(machine_code);
+            default:
+                return 0x0;
+        }
+    }
+
+    /**
+        Check whether instruction writes a register at WB, resolving any pending data hazard.
+
+        @param machine_code instruction machine code.
+    */
+    bool is_write_back(ISA::MachineCode machine_code) {
+        switch (get_opcode(machine_code)) {
+            case ISA::OpCode::R_COMMON:
+                switch (ISA::get_instruction_field(machine_code, ISA::Field::FUNCT)) {
+                    case ISA::Funct::ADD:
+                    case ISA::Funct::SUB:
+                    case ISA::Funct::AND:
+                    case ISA::Funct::OR:
+                    case ISA::Funct::SLL:
+                    case ISA::Funct::SRL:
+                        return 0x0 != get_ex_write(machine_code);
+                    case ISA::Funct::MUL:
+                        // upper half always goes to rd + 1:
+                        return true;
+                    default:
+                        return false;
+                }
+            case ISA::OpCode::ADDI:
+            case ISA::OpCode::ANDI:
+            case ISA::OpCode::ORI:
+            case ISA::OpCode::SLTI:
+            case ISA::OpCode::SLTIU:
+            case ISA::OpCode::LUI:
+            case ISA::OpCode::LW:
+                return 0x0 != get_ex_write(machine_code);
+            default:
+                return false;
+        }
+    }
+
+    /**
+        Get registers read, as register bit mask. Both rs & rt are taken, as at ID.
+
+        @param machine_code instruction machine code.
+    */
+    std::uint64_t get_reads(ISA::MachineCode machine_code) {
+        const std::uint64_t reads = (std::uint64_t(1) << ISA::get_instruction_field(machine_code, ISA::Field::RS)) |
+                                    (std::uint64_t(1) << ISA::get_instruction_field(machine_code, ISA::Field::RT));
+
+        return reads & ~ZERO;
+    }
+
+    /**
+        Get registers written, as register bit mask.
+
+        @param machine_code instruction machine code.
+    */
+    std::uint64_t get_writes(ISA::MachineCode machine_code) {
+        const std::uint64_t destination = std::uint64_t(1) << get_ex_write(machine_code);
+        std::uint64_t writes = 0;
+
+        switch (get_opcode(machine_code)) {
+            case ISA::OpCode::R_COMMON:
+                switch (ISA::get_instruction_field(machine_code, ISA::Field::FUNCT)) {
+                    case ISA::Funct::MUL:
+                        writes = destination | (destination << 1);
+                        break;
+                    case ISA::Funct::MULT:
+                        writes = HI_LO;
+                        break;
+                    default:
+                        writes = destination;
+                        break;
+                }
+                break;
+            case ISA::OpCode::SW:
+                break;
+            default:
+                writes = destination;
+                break;
+        }
+
+        return writes & ~ZERO;
+    }
+
+    bool is_mul(ISA::MachineCode machine_code) {
+        return ISA::OpCode::R_COMMON == get_opcode(machine_code) &&
+               ISA::Funct::MUL == ISA::get_instruction_field(machine_code, ISA::Field::FUNCT);
+    }
+
+    bool is_memory(ISA::MachineCode machine_code) {
+        return ISA::OpCode::LW == get_opcode(machine_code) || ISA::OpCode::SW == get_opcode(machine_code);
+    }
+
+    /**
+        Check whether instruction may move inside its basic block -- every known operation except branches.
+
+        @param machine_code instruction machine code.
+    */
+    bool is_movable(ISA::MachineCode machine_code) {
+        switch (get_opcode(machine_code)) {
+            case ISA::OpCode::R_COMMON:
+                switch (ISA::get_instruction_field(machine_code, ISA::Field::FUNCT)) {
+                    case ISA::Funct::ADD:
+                    case ISA::Funct::SUB:
+                    case ISA::Funct::AND:
+                    case ISA::Funct::OR:
+                    case ISA::Funct::MUL:
+                    case ISA::Funct::MULT:
+                    case ISA::Funct::SLL:
+                    case ISA::Funct::SRL:
+                        return true;
+                    default:
+                        return false;
+                }
+            case ISA::OpCode::ADDI:
+            case ISA::OpCode::ANDI:
+            case ISA::OpCode::ORI:
+            case ISA::OpCode::SLTI:
+            case ISA::OpCode::SLTIU:
+            case ISA::OpCode::LUI:
+            case ISA::OpCode::LW:
+            case ISA::OpCode::SW:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+        Check whether later instruction must stay behind earlier one -- RAW, WAR & WAW on registers, stores on memory.
+
+        @param earlier earlier instruction machine code.
+        @param later later instruction machine code.
+    */
+    bool depends(ISA::MachineCode earlier, ISA::MachineCode later) {
+        const std::uint64_t earlier_writes = get_writes(earlier);
+        const std::uint64_t later_writes = get_writes(later);
+
+        return (0 != (earlier_writes & (get_reads(later) | later_writes))) ||
+               (0 != (get_reads(earlier) & later_writes)) ||
+               (
+                   is_memory(earlier) && is_memory(later) &&
+                   (ISA::OpCode::SW == get_opcode(earlier) || ISA::OpCode::SW == get_opcode(later))
+               );
+    }
+
+    /**
+        Add stall cycles, saturating at DEADLOCK.
+
+        @param stalls accumulated stall cycles.
+        @param stall stall cycles of next instruction.
+    */
+    std::uint64_t add_stalls(std::uint64_t stalls, std::uint64_t stall) {
+        return (Scheduler::DEADLOCK == stalls || Scheduler::DEADLOCK == stall) ? Scheduler::DEADLOCK : stalls + stall;
+    }
+}
+
+/**
+    Get decode cycle of next instruction.
+
+    @param machine_code next instruction.
+    @param expected output decode cycle without data hazard.
+    @return decode cycle, DEADLOCK when the executor would never decode it.
+*/
+std::uint64_t Scheduler::Timeline::get_cycle(ISA::MachineCode machine_code, std::uint64_t &expected) const {
+    // a. next cycle, or one more behind a branch while IF waits for it to reach EX_MEM, unless it fetches the delay slot:
+    expected = 0;
+    if (0 < count) {
+        expected = cycles[count - 1] + ((is_branch(codes[count - 1]) && !delay_slot) ? 2 : 1);
+    }
+
+    const ISA::Word a_reg_addr = ISA::get_instruction_field(machine_code, ISA::Field::RS);
+    const ISA::Word b_reg_addr = ISA::get_instruction_field(machine_code, ISA::Field::RT);
+
+    std::uint64_t cycle = expected;
+    for (;;) {
+        // b. data hazard against producers in EX_MEM & MEM_WB:
+        bool hazard = false;
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint64_t distance = cycle - cycles[i];
+            const ISA::Word write_reg_addr = (1 == distance) ? get_ex_write(codes[i]) : ((2 == distance) ? get_mem_write(codes[i]) : 0x0);
+
+            if (0x0 != write_reg_addr && (write_reg_addr == a_reg_addr || write_reg_addr == b_reg_addr)) {
+                hazard = true;
+            }
+        }
+        if (!hazard) {
+            return cycle;
+        }
+
+        // c. stalled branch is overwritten by the nop IF inserts for its control hazard:
+        if (is_branch(machine_code) && !delay_slot) {
+            return DEADLOCK;
+        }
+
+        // d. data hazard stays until the next register write at WB, three cycles after its decode:
+        std::uint64_t release = DEADLOCK;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (cycle < cycles[i] + 3 && is_write_back(codes[i]) && cycles[i] + 3 < release) {
+                release = cycles[i] + 3;
+            }
+        }
+        if (DEADLOCK == release) {
+            return DEADLOCK;
+        }
+        cycle = release;
+    }
+}
+
+/**
+    Check whether instruction decoded at cycle reads a register before its write back goes unchecked.
+
+    @param machine_code next instruction.
+    @param cycle decode cycle.
+*/
+bool Scheduler::Timeline::is_stale(ISA::MachineCode machine_code, std::uint64_t cycle) const {
+    const ISA::Word a_reg_addr = ISA::get_instruction_field(machine_code, ISA::Field::RS);
+    const ISA::Word b_reg_addr = ISA::get_instruction_field(machine_code, ISA::Field::RT);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (is_mul(codes[i]) && cycle < cycles[i] + 3) {
+            const ISA::Word upper_reg_addr = get_ex_write(codes[i]) + 1;
+            if (upper_reg_addr == a_reg_addr || upper_reg_addr == b_reg_addr) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+    Predict data hazard stall cycles of next instruction, without decoding it.
+
+    @param machine_code next instruction in fall-through order.
+    @param stale output true when it would read a stale register.
+    @return stall cycles, DEADLOCK when the executor would never decode it.
+*/
+std::uint64_t Scheduler::Timeline::peek(ISA::MachineCode machine_code, bool &stale) const {
+    std::uint64_t expected;
+    const std::uint64_t cycle = get_cycle(machine_code, expected);
+
+    stale = (DEADLOCK != cycle) && is_stale(machine_code, cycle);
+
+    return (DEADLOCK == cycle) ? DEADLOCK : cycle - expected;
+}
+
+/**
+    Decode next instruction. After a deadlock the model goes on as if it was decoded without stall.
+
+    @param machine_code next instruction in fall-through order.
+    @return stall cycles, DEADLOCK when the executor would never decode it.
+*/
+std::uint64_t Scheduler::Timeline::decode(ISA::MachineCode machine_code) {
+    std::uint64_t expected;
+    const std::uint64_t cycle = get_cycle(machine_code, expected);
+
+    if (DEADLOCK != cycle && is_stale(machine_code, cycle)) {
+        ++stale_reads;
+    }
+
+    if (WINDOW == count) {
+        for (std::size_t i = 1; i < WINDOW; ++i) {
+            codes[i - 1] = codes[i];
+            cycles[i - 1] = cycles[i];
+        }
+        --count;
+    }
+    codes[count] = machine_code;
+    cycles[count] = (DEADLOCK == cycle) ? expected : cycle;
+    ++count;
+
+    return (DEADLOCK == cycle) ? DEADLOCK : cycle - expected;
+}
+
+/**
+    Check whether both timelines decode any following instructions alike.
+
+    @param other other timeline.
+*/
+bool Scheduler::Timeline::is_aligned(const Timeline &other) const {
+    if (count != other.count) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (
+            codes[i] != other.codes[i] ||
+            cycles[count - 1] - cycles[i] != other.cycles[count - 1] - other.cycles[i]
+        ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+    Predict data hazard stall cycles of instructions in fall-through order.
+
+    @param machine_codes instructions in address order.
+    @return stall cycles, DEADLOCK when the executor would never get through.
+*/
+std::uint64_t Scheduler::predict(const std::vector<ISA::MachineCode> &machine_codes) {
+    Timeline timeline;
+    std::uint64_t stalls = 0;
+
+    for (const ISA::MachineCode machine_code: machine_codes) {
+        stalls = add_stalls(stalls, timeline.decode(machine_code));
+    }
+
+    return stalls;
+}
+
+/**
+    Reorder independent instructions inside basic blocks. Leaders & branches stay in place,
+    so labels & branch offsets remain valid.
+
+    @param machine_codes instructions in address order.
+    @param leaders true for instructions starting a basic block -- labels & branch targets.
+    @param report output block & predicted stall counts.
+    @return scheduled order, original index of instruction at each address.
+*/
+std::vector<std::size_t> Scheduler::schedule(
+    const std::vector<ISA::MachineCode> &machine_codes,
+    const std::vector<bool> &leaders,
+    Report &report
+) {
+    const std::size_t N = machine_codes.size();
+
+    std::vector<std::size_t> order(N);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<ISA::MachineCode> scheduled(machine_codes);
+
+    report = {0, 0, predict(machine_codes), 0};
+
+    Timeline timeline;
+    for (std::size_t begin = 0; begin < N;) {
+        // a. region -- run of movable instructions inside one basic block:
+        std::size_t end = begin;
+        while (
+            end < N && end - begin < MAX_REGION && is_movable(machine_codes[end]) &&
+            (begin == end || !leaders[end])
+        ) {
+            ++end;
+        }
+        if (end - begin < 2) {
+            // branch, unknown operation or single instruction, stays in place:
+            timeline.decode(machine_codes[begin]);
+            begin = std::max(end, begin + 1);
+            continue;
+        }
+        ++report.blocks;
+
+        // b. keep schedule only if it beats original order, followed until both decode alike. Any stale read keeps original order:
+        const std::vector<std::size_t> region = schedule_region(machine_codes, begin, end, timeline);
+
+        Timeline original(timeline), candidate(timeline);
+        std::uint64_t original_stalls = 0, candidate_stalls = 0;
+        for (std::size_t i = 0; i < region.size(); ++i) {
+            original_stalls = add_stalls(original_stalls, original.decode(machine_codes[begin + i]));
+            candidate_stalls = add_stalls(candidate_stalls, candidate.decode(machine_codes[region[i]]));
+        }
+        std::size_t next = end;
+        while (next < N && next < end + MAX_LOOKAHEAD && !candidate.is_aligned(original)) {
+            original_stalls = add_stalls(original_stalls, original.decode(machine_codes[next]));
+            candidate_stalls = add_stalls(candidate_stalls, candidate.decode(machine_codes[next]));
+            ++next;
+        }
+
+        if (
+            (N == next || candidate.is_aligned(original)) &&
+            candidate_stalls < original_stalls &&
+            timeline.get_stale_reads() == original.get_stale_reads() &&
+            timeline.get_stale_reads() == candidate.get_stale_reads()
+        ) {
+            for (std::size_t i = 0; i < region.size(); ++i) {
+                order[begin + i] = region[i];
+                scheduled[begin + i] = machine_codes[region[i]];
+            }
+            ++report.reordered;
+        }
+
+        // c. commit:
+        for (std::size_t i = begin; i < end; ++i) {
+            timeline.decode(scheduled[i]);
+        }
+        begin = end;
+    }
+
+    report.stalls_after = predict(scheduled);
+
+    return order;
+}
+
+/**
+    Insert a delay slot behind every branch & fill it with the nearest instruction of its basic block
+    that the branch does not depend on, if that adds no predicted stall on either path. Leaders,
+    branches & mul, whose upper half is written unchecked, stay in place.
+
+    @param machine_codes instructions in address order.
+    @param leaders true for instructions starting a basic block -- labels & branch targets.
+    @param report output slot counts.
+    @return layout with delay slots, original index of instruction at each address or NOP.
+*/
+std::vector<std::size_t> Scheduler::fill_delay_slots(
+    const std::vector<ISA::MachineCode> &machine_codes,
+    const std::vector<bool> &leaders,
+    DelaySlotReport &report
+) {
+    const std::size_t N = machine_codes.size();
+
+    std::vector<std::size_t> layout;
+    layout.reserve(N);
+    report = {0, 0};
+
+    Timeline timeline(true);
+    std::size_t begin = 0;
+    for (std::size_t branch = 0; branch < N; ++branch) {
+        if (!is_branch(machine_codes[branch])) {
+            continue;
+        }
+        ++report.slots;
+
+        // a. lay out instructions beyond reach of the candidate search:
+        for (; begin + MAX_REGION < branch; ++begin) {
+            layout.push_back(begin);
+            timeline.decode(machine_codes[begin]);
+        }
+
+        // b. nearest candidate above the branch inside its basic block, independent of everything down to the branch:
+        std::size_t slot = NOP;
+        for (std::size_t i = branch; NOP == slot && begin < i && !leaders[i];) {
+            --i;
+            if (leaders[i] || !is_movable(machine_codes[i])) {
+                break;
+            }
+            if (is_mul(machine_codes[i])) {
+                continue;
+            }
+
+            bool independent = true;
+            for (std::size_t j = i + 1; independent && j <= branch; ++j) {
+                independent = !depends(machine_codes[i], machine_codes[j]);
+            }
+            if (independent && is_fillable(machine_codes, begin, branch, i, timeline)) {
+                slot = i;
+            }
+        }
+
+        // c. lay out block, branch & its delay slot:
+        for (; begin < branch; ++begin) {
+            if (slot != begin) {
+                layout.push_back(begin);
+                timeline.decode(machine_codes[begin]);
+            }
+        }
+        layout.push_back(branch);
+        timeline.decode(machine_codes[branch]);
+        layout.push_back(slot);
+        timeline.decode((NOP == slot) ? NOP_MACHINE_CODE : machine_codes[slot]);
+        begin = branch + 1;
+
+        if (NOP != slot) {
+            ++report.filled;
+        }
+    }
+    for (; begin < N; ++begin) {
+        layout.push_back(begin);
+    }
+
+    return layout;
+}
+
+/**
+    Schedule one region with greedy list scheduling, least predicted stalls first.
+
+    @param machine_codes instructions in address order.
+    @param begin first instruction of region.
+    @param end one past last movable instruction of region.
+    @param timeline decode cycles of already scheduled instructions.
+    @return scheduled order of region, original indices.
+*/
+std::vector<std::size_t> Scheduler::schedule_region(
+    const std::vector<ISA::MachineCode> &machine_codes,
+    std::size_t begin, std::size_t end,
+    const Timeline &timeline
+) {
+    const std::size_t N = end - begin;
+
+    // a. dependence graph:
+    std::vector<std::vector<std::size_t>> successors(N);
+    std::vector<std::size_t> num_predecessors(N, 0);
+    for (std::size_t j = 0; j < N; ++j) {
+        for (std::size_t i = 0; i < j; ++i) {
+            if (depends(machine_codes[begin + i], machine_codes[begin + j])) {
+                successors[i].push_back(j);
+                ++num_predecessors[j];
+            }
+        }
+    }
+
+    // b. priority -- longest dependence chain down to end of region:
+    std::vector<std::size_t> height(N, 1);
+    for (std::size_t i = N; 0 < i--;) {
+        for (const std::size_t j: successors[i]) {
+            height[i] = std::max(height[i], height[j] + 1);
+        }
+    }
+
+    // c. pick ready instruction without stale read, then with least stall, then longest chain, then original order:
+    std::vector<std::size_t> order;
+    std::vector<bool> done(N, false);
+    Timeline scheduled(timeline);
+    while (order.size() < N) {
+        std::size_t best = N;
+        bool best_stale = true;
+        std::uint64_t best_stall = DEADLOCK;
+        for (std::size_t i = 0; i < N; ++i) {
+            if (done[i] || 0 < num_predecessors[i]) {
+                continue;
+            }
+
+            bool stale;
+            const std::uint64_t stall = scheduled.peek(machine_codes[begin + i], stale);
+            if (
+                N == best || (!stale && best_stale) ||
+                (stale == best_stale && (stall < best_stall || (stall == best_stall && height[i] > height[best])))
+            ) {
+                best = i;
+                best_stale = stale;
+                best_stall = stall;
+            }
+        }
+
+        scheduled.decode(machine_codes[begin + best]);
+        done[best] = true;
+        for (const std::size_t j: successors[best]) {
+            --num_predecessors[j];
+        }
+        order.push_back(begin + best);
+    }
+
+    return order;
+}
+
+/**
+    Check whether moving candidate into the delay slot of branch adds neither stall nor stale read against a nop,
+    down both paths until both layouts decode alike.
+
+    @param machine_codes instructions in address order.
+    @param begin first instruction not yet laid out.
+    @param branch branch index.
+    @param candidate instruction moved into the delay slot.
+    @param timeline decode cycles of instructions already laid out.
+*/
+bool Scheduler::is_fillable(
+    const std::vector<ISA::MachineCode> &machine_codes,
+    std::size_t begin, std::size_t branch, std::size_t candidate,
+    const Timeline &timeline
+) {
+    const std::size_t N = machine_codes.size();
+
+    // a. fall-through path, then taken path inside text segment:
+    std::vector<std::size_t> paths(1, branch + 1);
+    const std::int16_t offset = ISA::get_instruction_field(machine_codes[branch], ISA::Field::IMM);
+    const std::int64_t target = std::int64_t(branch) + 1 + offset;
+    if (0 <= target && target < std::int64_t(N) && std::size_t(target) != branch + 1) {
+        paths.push_back(target);
+    }
+
+    for (const std::size_t path: paths) {
+        // b. block & branch, with a nop or the candidate in its delay slot:
+        Timeline original(timeline), filled(timeline);
+        std::uint64_t original_stalls = 0, filled_stalls = 0;
+        for (std::size_t i = begin; i <= branch; ++i) {
+            original_stalls = add_stalls(original_stalls, original.decode(machine_codes[i]));
+            if (candidate != i) {
+                filled_stalls = add_stalls(filled_stalls, filled.decode(machine_codes[i]));
+            }
+        }
+        original_stalls = add_stalls(original_stalls, original.decode(NOP_MACHINE_CODE));
+        filled_stalls = add_stalls(filled_stalls, filled.decode(machine_codes[candidate]));
+
+        // c. followed until both decode alike:
+        std::size_t next = path;
+        while (next < N && next < path + MAX_LOOKAHEAD && !filled.is_aligned(original)) {
+            original_stalls = add_stalls(original_stalls, original.decode(machine_codes[next]));
+            filled_stalls = add_stalls(filled_stalls, filled.decode(machine_codes[next]));
+            ++next;
+        }
+
+        if (
+            !(N == next || filled.is_aligned(original)) ||
+            DEADLOCK == filled_stalls || original_stalls < filled_stalls ||
+            timeline.get_stale_reads() != original.get_stale_reads() ||
+            timeline.get_stale_reads() != filled.get_stale_reads()
+        ) {
+            return false;
+        }
+    }
+
+    return true;
+}
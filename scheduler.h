@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cinttypes>
+#include <limits>
+#include <vector>
+
+#include "isa.h"
+
+/**
+ *  Hazard-aware instruction scheduler -- reorders independent instructions inside basic blocks
+ *  to separate RAW-dependent pairs. Stalls are predicted by a straight-line model of the data
+ *  hazard rules of Executor::execute_ID, a consumer decoded one or two cycles after its producer
+ *  is held until the producer writes back.
+ */
+class Scheduler {
+public:
+    // predicted stall cycles of a sequence the pipelined executor never gets through:
+    static const std::uint64_t DEADLOCK = std::numeric_limits<std::uint64_t>::max();
+
+    struct Report {
+        std::size_t blocks;
+        std::size_t reordered;
+        // predicted data hazard stall cycles along fall-through path:
+        std::uint64_t stalls_before;
+        std::uint64_t stalls_after;
+    };
+
+    // delay slot without a safe instruction to fill it, takes a nop:
+    static const std::size_t NOP = std::numeric_limits<std::size_t>::max();
+    // sll $zero $zero 0x00, writes nothing:
+    static const ISA::MachineCode NOP_MACHINE_CODE = 0x00000000;
+
+    struct DelaySlotReport {
+        std::size_t slots;
+        std::size_t filled;
+    };
+
+    /**
+     *  Decode cycles of a straight-line instruction sequence, after Executor::execute_ID & execute_IF.
+     */
+    class Timeline {
+    public:
+        /**
+            @param delay_slot true when the instruction behind each branch is fetched without waiting for it.
+        */
+        Timeline(bool delay_slot = false): delay_slot(delay_slot), count(0), stale_reads(0) {}
+
+        /**
+            Predict data hazard stall cycles of next instruction, without decoding it.
+
+            @param machine_code next instruction in fall-through order.
+            @param stale output true when it would read a stale register.
+            @return stall cycles, DEADLOCK when the executor would never decode it.
+        */
+        std::uint64_t peek(ISA::MachineCode machine_code, bool &stale) const;
+
+        /**
+            Decode next instruction.
+
+            @param machine_code next instruction in fall-through order.
+            @return stall cycles, DEADLOCK when the executor would never decode it.
+        */
+        std::uint64_t decode(ISA::MachineCode machine_code);
+
+        /**
+            Get number of stale register reads -- the upper half of mul goes to rd + 1, which ID does not check.
+        */
+        std::size_t get_stale_reads(void) const {return stale_reads;}
+
+        /**
+            Check whether both timelines decode any following instructions alike.
+
+            @param other other timeline.
+        */
+        bool is_aligned(const Timeline &other) const;
+    private:
+        // instructions decoded within the last three cycles, the only ones still ahead of WB:
+        static const std::size_t WINDOW = 3;
+
+        bool delay_slot;
+        ISA::MachineCode codes[WINDOW];
+        std::uint64_t cycles[WINDOW];
+        std::size_t count;
+        std::size_t stale_reads;
+
+        /**
+            Get decode cycle of next instruction.
+
+            @param machine_code next instruction.
+            @param expected output decode cycle without data hazard.
+            @return decode cycle, DEADLOCK when the executor would never decode it.
+        */
+        std::uint64_t get_cycle(ISA::MachineCode machine_code, std::uint64_t &expected) const;
+
+        /**
+            Check whether instruction decoded at cycle reads a register before its write back goes unchecked.
+
+            @param machine_code next instruction.
+            @param cycle decode cycle.
+        */
+        bool is_stale(ISA::MachineCode machine_code, std::uint64_t cycle) const;
+    };
+
+    /**
+        Predict data hazard stall cycles of instructions in fall-through order.
+
+        @param machine_codes instructions in address order.
+        @return stall cycles, DEADLOCK when the executor would never get through.
+    */
+    static std::uint64_t predict(const std::vector<ISA::MachineCode> &machine_codes);
+
+    /**
+        Reorder independent instructions inside basic blocks. Leaders & branches stay in place,
+        so labels & branch offsets remain valid.
+
+        @param machine_codes instructions in address order.
+        @param leaders true for instructions starting a basic block -- labels & branch targets.
+        @param report output block & predicted stall counts.
+        @return scheduled order, original index of instruction at each address.
+    */
+    static std::vector<std::size_t> schedule(
+        const std::vector<ISA::MachineCode> &machine_codes,
+        const std::vector<bool> &leaders,
+        Report &report
+    );
+
+    /**
+        Insert a delay slot behind every branch & fill it with the nearest instruction of its basic block
+        that the branch does not depend on, if that adds no predicted stall on either path. Leaders,
+        branches & mul, whose upper half is written unchecked, stay in place.
+
+        @param machine_codes instructions in address order.
+        @param leaders true for instructions starting a basic block -- labels & branch targets.
+        @param report output slot counts.
+        @return layout with delay slots, original index of instruction at each address or NOP.
+    */
+    static std::vector<std::size_t> fill_delay_slots(
+        const std::vector<ISA::MachineCode> &machine_codes,
+        const std::vector<bool> &leaders,
+        DelaySlotReport &report
+    );
+private:
+    // longest run of a basic block scheduled as one, bounding the quadratic dependence analysis:
+    static const std::size_t MAX_REGION = 64;
+    // instructions past a region followed until both orders decode alike:
+    static const std::size_t MAX_LOOKAHEAD = 8;
+
+    /**
+        Schedule one region with greedy list scheduling, least predicted stalls first.
+
+        @param machine_codes instructions in address order.
+        @param begin first instruction of region.
+        @param end one past last movable instruction of region.
+        @param timeline decode cycles of already scheduled instructions.
+        @return scheduled order of region, original indices.
+    */
+    static std::vector<std::size_t> schedule_region(
+        const std::vector<ISA::MachineCode> &machine_codes,
+        std::size_t begin, std::size_t end,
+        const Timeline &timeline
+    );
+
+    /**
+        Check whether moving candidate into the delay slot of branch adds neither stall nor stale read against a nop,
+        down both paths until both layouts decode alike.
+
+        @param machine_codes instructions in address order.
+        @param begin first instruction not yet laid out.
+        @param branch branch index.
+        @param candidate instruction moved into the delay slot.
+        @param timeline decode cycles of instructions already laid out.
+    */
+    static bool is_fillable(
+        const std::vector<ISA::MachineCode> &machine_codes,
+        std::size_t begin, std::size_t branch, std::size_t candidate,
+        const Timeline &timeline
+    );
+};
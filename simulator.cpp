@@ -0,0 +1,175 @@
+#include "simulator.h"
+
+#include <stdexcept>
+
+#include "assembler.h"
+
+namespace {
+    /**
+        Throw assembly errors, if any, with their reports.
+
+        @param assembler assembler after assembly.
+        @param input input ASM description.
+    */
+    void check_assembled(const Assembler &assembler, const std::string &input) {
+        if (0 == assembler.get_num_errors()) {
+            return;
+        }
+
+        std::string errors = assembler.get_errors();
+        if (!errors.empty() && '\n' == errors.back()) {
+            errors.pop_back();
+        }
+        throw std::runtime_error("cannot assemble " + input + " -- " + std::to_string(assembler.get_num_errors()) + " error(s)\n" + errors);
+    }
+}
+
+Simulator::Simulator(const Config &config): CONFIG(config), data_segment(0x00000000), executor(text_segment, data_segment) {
+    if (CONFIG.fill_delay_slots && !CONFIG.delay_slot) {
+        throw std::runtime_error("fill delay slots requires delay slot");
+    }
+
+    executor.set_delay_slot(CONFIG.delay_slot);
+}
+
+/**
+    Load ASM file or binary program image, told apart by magic. Assembly errors are thrown
+    with their reports, which also go to std::cerr.
+
+    @param filename input ASM or program image filename.
+*/
+void Simulator::load_file(const std::string &filename) {
+    if (ProgramImage::is_image(filename)) {
+        ProgramImageReader reader(filename);
+        load(reader.get_text_segment(), reader.get_data());
+        return;
+    }
+
+    Assembler assembler(filename, CONFIG.text_starting_addr, CONFIG.jobs, CONFIG.schedule, CONFIG.fill_delay_slots);
+    check_assembled(assembler, "input ASM file " + filename);
+    const ISA::TextSegment text = assembler.get_text_segment();
+    if (text.is_empty()) {
+        throw std::runtime_error("no instructions in input ASM file " + filename);
+    }
+    load(text, ProgramImage::DataWords());
+}
+
+/**
+    Load ASM source text, assembly errors are thrown as for files.
+
+    @param source input ASM source text.
+*/
+void Simulator::load_source(std::string_view source) {
+    Assembler assembler = Assembler::from_source(source, CONFIG.text_starting_addr, CONFIG.jobs, CONFIG.schedule, CONFIG.fill_delay_slots);
+    check_assembled(assembler, "input ASM source");
+    const ISA::TextSegment text = assembler.get_text_segment();
+    if (text.is_empty()) {
+        throw std::runtime_error("no instructions in input ASM source");
+    }
+    load(text, ProgramImage::DataWords());
+}
+
+/**
+    Load machine code, rendered by the disassembler.
+
+    @param machine_codes instructions in address order, from text starting address.
+    @param data initial data segment words.
+*/
+void Simulator::load_binary(const std::vector<ISA::MachineCode> &machine_codes, const ProgramImage::DataWords &data) {
+    if (machine_codes.empty()) {
+        throw std::runtime_error("no instructions in machine code");
+    }
+
+    ISA::TextSegment text;
+    for (std::size_t i = 0; i < machine_codes.size(); ++i) {
+        text.set(CONFIG.text_starting_addr + ISA::Address(i << 2), machine_codes[i], std::string_view());
+    }
+    load(text, data);
+}
+
+/**
+    Restore clean registers & initial data memory of loaded program, reusing its executor.
+*/
+void Simulator::reset(void) {
+    check_loaded();
+
+    // a. initial data memory:
+    data_segment.clear();
+    for (const auto &word: initial_data) {
+        data_segment.set(word.first, word.second);
+    }
+
+    // b. clean register file & pipeline:
+    executor.reset(data_segment);
+}
+
+/**
+    Restore clean registers & replace initial data memory of loaded program, for reruns on new inputs.
+
+    @param data initial data segment words.
+*/
+void Simulator::reset(const ProgramImage::DataWords &data) {
+    check_loaded();
+
+    initial_data = data;
+    reset();
+}
+
+/**
+    Get architectural register value.
+
+    @param reg_addr register address.
+*/
+std::int32_t Simulator::get_register(std::size_t reg_addr) const {
+    check_loaded();
+    if (NUM_REG <= reg_addr) {
+        throw std::runtime_error("invalid register address " + std::to_string(reg_addr));
+    }
+
+    return executor.get_register(reg_addr);
+}
+
+/**
+    Get data memory word.
+
+    @param address word address.
+*/
+ISA::Word Simulator::get_memory(ISA::Address address) {
+    check_loaded();
+
+    return data_segment.get(address);
+}
+
+/**
+    Replace loaded program & reset.
+
+    @param text text segment.
+    @param data initial data segment words.
+*/
+void Simulator::load(const ISA::TextSegment &text, const ProgramImage::DataWords &data) {
+    text_segment = text;
+    initial_data = data;
+
+    reset();
+}
+
+/**
+    Run loaded program.
+
+    @param MODE execution mode.
+    @param N execution time.
+*/
+void Simulator::run(const std::string &MODE, const int N) {
+    check_loaded();
+
+    executor.run(MODE, N);
+}
+
+/**
+    Check that a program is loaded.
+*/
+void Simulator::check_loaded(void) const {
+    if (text_segment.is_empty()) {
+        throw std::runtime_error("no program loaded");
+    }
+}
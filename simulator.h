@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cinttypes>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "isa.h"
+#include "json.h"
+#include "program_image.h"
+#include "executor.h"
+
+/**
+ *  Embeddable MIPS simulator -- loads a program from ASM file, ASM source text, program image
+ *  or machine code, runs it on the pipelined executor & reports statistics in memory, without
+ *  any output file. Errors are thrown as std::runtime_error.
+ */
+class Simulator {
+public:
+    static const std::size_t NUM_REG = 32;
+
+    struct Config {
+        // assembly:
+        std::uint32_t text_starting_addr;
+        std::size_t jobs;
+        bool schedule;
+        bool fill_delay_slots;
+        // core -- always execute the instruction behind each branch:
+        bool delay_slot;
+
+        Config():
+            text_starting_addr(0x00400000), jobs(1),
+            schedule(false), fill_delay_slots(false),
+            delay_slot(false) {}
+    };
+
+    /**
+        @param config assembly & core configuration.
+    */
+    Simulator(const Config &config = Config());
+
+    Simulator(const Simulator &) = delete;
+    Simulator &operator=(const Simulator &) = delete;
+
+    /**
+        Load ASM file or binary program image, told apart by magic. Assembly errors are thrown
+        with their reports, which also go to std::cerr.
+
+        @param filename input ASM or program image filename.
+    */
+    void load_file(const std::string &filename);
+
+    /**
+        Load ASM source text, assembly errors are thrown as for files.
+
+        @param source input ASM source text.
+    */
+    void load_source(std::string_view source);
+
+    /**
+        Load machine code, rendered by the disassembler.
+
+        @param machine_codes instructions in address order, from text starting address.
+        @param data initial data segment words.
+    */
+    void load_binary(const std::vector<ISA::MachineCode> &machine_codes, const ProgramImage::DataWords &data = ProgramImage::DataWords());
+
+    /**
+        Run loaded program from its first instruction, on registers & data memory left by previous runs.
+
+        @param N number of clock cycles or fetched instructions.
+    */
+    void run_cycles(const int N) {run("cycle", N);}
+    void run_instructions(const int N) {run("instruction", N);}
+
+    /**
+        Restore clean registers & initial data memory of loaded program, reusing its executor.
+    */
+    void reset(void);
+
+    /**
+        Restore clean registers & replace initial data memory of loaded program, for reruns on new inputs.
+
+        @param data initial data segment words.
+    */
+    void reset(const ProgramImage::DataWords &data);
+
+    /**
+        Get resource utilization of last run.
+    */
+    Executor::Stats get_stats(void) const {check_loaded(); return executor.get_stats();}
+
+    /**
+        Get architectural register value, throws std::runtime_error outside the register file.
+
+        @param reg_addr register address.
+    */
+    std::int32_t get_register(std::size_t reg_addr) const;
+
+    /**
+        Get data memory word.
+
+        @param address word address.
+    */
+    ISA::Word get_memory(ISA::Address address);
+
+    /**
+        Fill register contents & resource utilization report, as dumped by the simulator.
+
+        @param report output JSON report.
+    */
+    void report(nlohmann::json &report) const {check_loaded(); executor.report(report);}
+
+    ISA::TextSegment &get_text_segment(void) {return text_segment;}
+private:
+    const Config CONFIG;
+
+    ISA::TextSegment text_segment;
+    ProgramImage::DataWords initial_data;
+    // reused across loads & resets:
+    ISA::DataSegment data_segment;
+    Executor executor;
+
+    /**
+        Replace loaded program & reset.
+
+        @param text text segment.
+        @param data initial data segment words.
+    */
+    void load(const ISA::TextSegment &text, const ProgramImage::DataWords &data);
+
+    /**
+        Run loaded program.
+
+        @param MODE execution mode.
+        @param N execution time.
+    */
+    void run(const std::string &MODE, const int N);
+
+    /**
+        Check that a program is loaded.
+    */
+    void check_loaded(void) const;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <cstddef>
+
+/**
+ *  Lock-free single-producer single-consumer ring buffer.
+ *
+ *  Exactly one thread may call push/try_push/close and exactly one
+ *  other thread may call pop/try_pop/cancel. Capacity is rounded up to a power of two.
+ */
+template <typename T>
+class SPSCQueue {
+public:
+    explicit SPSCQueue(std::size_t capacity = 4096): head(0), tail(0), closed(false), cancelled(false) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        buffer.resize(size);
+        MASK = size - 1;
+    }
+
+    /**
+        Try to append one element without blocking.
+
+        @param value element to append.
+        @return true on success, false if the queue is full.
+    */
+    bool try_push(const T &value) {
+        const std::size_t current_tail = tail.load(std::memory_order_relaxed);
+
+        if (current_tail - head.load(std::memory_order_acquire) > MASK) {
+            return false;
+        }
+
+        buffer[current_tail & MASK] = value;
+        tail.store(current_tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+        Append one element, spinning while the queue is full.
+
+        @param value element to append.
+        @return true on success, false if the consumer has cancelled.
+    */
+    bool push(const T &value) {
+        while (!try_push(value)) {
+            if (is_cancelled()) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+
+        return !is_cancelled();
+    }
+
+    /**
+        Try to remove one element without blocking.
+
+        @param value output element.
+        @return true on success, false if the queue is empty.
+    */
+    bool try_pop(T &value) {
+        const std::size_t current_head = head.load(std::memory_order_relaxed);
+
+        if (current_head == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = buffer[current_head & MASK];
+        head.store(current_head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+        Remove one element, spinning while the queue is empty and still open.
+
+        @param value output element.
+        @return true on success, false once the queue is closed and drained.
+    */
+    bool pop(T &value) {
+        while (!try_pop(value)) {
+            if (closed.load(std::memory_order_acquire)) {
+                // the producer may have pushed right before closing:
+                return try_pop(value);
+            }
+            std::this_thread::yield();
+        }
+
+        return true;
+    }
+
+    /**
+        Mark end of stream. Called by the producer after its last push.
+    */
+    void close(void) {
+        closed.store(true, std::memory_order_release);
+    }
+
+    /**
+        Mark stream as no longer needed. Called by the consumer, e.g. once its cycle budget is exhausted.
+    */
+    void cancel(void) {
+        cancelled.store(true, std::memory_order_relaxed);
+    }
+    bool is_cancelled(void) const {
+        return cancelled.load(std::memory_order_relaxed);
+    }
+private:
+    // consumer & producer indices live on separate cache lines:
+    alignas(64) std::atomic<std::size_t> head;
+    alignas(64) std::atomic<std::size_t> tail;
+    alignas(64) std::atomic<bool> closed;
+    std::atomic<bool> cancelled;
+
+    std::size_t MASK;
+    std::vector<T> buffer;
+};
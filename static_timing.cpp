@@ -0,0 +1,344 @@
+#include "static_timing.h"
+
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+
+#include "scheduler.h"
+
+namespace {
+    bool is_branch(ISA::MachineCode machine_code) {
+        return ISA::OpCode::BEQ == ISA::get_instruction_field(machine_code, ISA::Field::OPCODE);
+    }
+
+    /**
+        Get branch target index, may lie outside text segment.
+
+        @param index branch index.
+        @param machine_code branch machine code.
+    */
+    std::int64_t get_target(std::size_t index, ISA::MachineCode machine_code) {
+        const std::int16_t offset = ISA::get_instruction_field(machine_code, ISA::Field::IMM);
+
+        return std::int64_t(index) + 1 + offset;
+    }
+
+    /**
+        Add stall cycles, saturating at DEADLOCK.
+    */
+    std::uint64_t add_stalls(std::uint64_t stalls, std::uint64_t stall) {
+        return (Scheduler::DEADLOCK == stalls || Scheduler::DEADLOCK == stall) ? Scheduler::DEADLOCK : stalls + stall;
+    }
+
+    std::string to_hex(ISA::Address address) {
+        std::stringstream ss;
+        ss << "0x" << std::setfill('0') << std::setw(8) << std::hex << address;
+
+        return ss.str();
+    }
+
+    /**
+        Format clock cycles, "deadlock" when the executor never gets through.
+    */
+    std::string to_cycles(std::uint64_t cycles) {
+        return (Scheduler::DEADLOCK == cycles) ? std::string("deadlock") : std::to_string(cycles);
+    }
+
+    /**
+        Sum instructions, stall cycles & bubbles, saturating at DEADLOCK.
+    */
+    std::uint64_t get_cycles(std::size_t num_instructions, std::uint64_t stalls, std::uint64_t bubbles) {
+        return add_stalls(stalls, num_instructions + bubbles);
+    }
+}
+
+StaticTiming::StaticTiming(ISA::TextSegment &text, bool delay_slot):
+    text_segment(text),
+    TEXT_SEGMENT_BEGIN(text.get_address_first()),
+    DELAY_SLOT(delay_slot) {
+    const std::size_t N = ((text.get_address_last() - TEXT_SEGMENT_BEGIN) >> 2) + 1;
+
+    machine_codes.resize(N);
+    for (std::size_t i = 0; i < N; ++i) {
+        machine_codes[i] = text.get_binary(TEXT_SEGMENT_BEGIN + (i << 2));
+    }
+
+    build_blocks();
+    predict_stalls();
+    find_loops();
+}
+
+/**
+    Get index of branch ending block, number of instructions if it ends without one.
+
+    @param block basic block.
+*/
+std::size_t StaticTiming::get_branch(const Block &block) const {
+    const std::size_t first = (block.first - TEXT_SEGMENT_BEGIN) >> 2;
+    const std::size_t last = (block.last - TEXT_SEGMENT_BEGIN) >> 2;
+
+    if (is_branch(machine_codes[last])) {
+        return last;
+    }
+    if (DELAY_SLOT && first < last && is_branch(machine_codes[last - 1])) {
+        return last - 1;
+    }
+
+    return machine_codes.size();
+}
+
+/**
+    Split text segment into basic blocks & link them.
+*/
+void StaticTiming::build_blocks(void) {
+    const std::size_t N = machine_codes.size();
+    const std::size_t SLOTS = DELAY_SLOT ? 1 : 0;
+
+    // a. leaders -- first instruction, branch targets & instructions behind branches, past their delay slots:
+    std::vector<bool> leaders(N, false);
+    leaders[0] = true;
+    for (std::size_t i = 0; i < N; ++i) {
+        if (is_branch(machine_codes[i])) {
+            const std::int64_t target = get_target(i, machine_codes[i]);
+            if (0 <= target && target < std::int64_t(N)) {
+                leaders[target] = true;
+            }
+            if (i + 1 + SLOTS < N) {
+                leaders[i + 1 + SLOTS] = true;
+            }
+        }
+    }
+
+    // b. blocks:
+    std::vector<std::size_t> block_index(N);
+    for (std::size_t i = 0; i < N; ++i) {
+        if (leaders[i]) {
+            blocks.push_back({TEXT_SEGMENT_BEGIN + ISA::Address(i << 2), 0, 0, 0, 0, {}});
+        }
+        Block &block = blocks.back();
+        block.last = TEXT_SEGMENT_BEGIN + ISA::Address(i << 2);
+        ++block.num_instructions;
+        block_index[i] = blocks.size() - 1;
+    }
+
+    // c. edges, fall-through first:
+    for (std::size_t b = 0; b < blocks.size(); ++b) {
+        Block &block = blocks[b];
+        const std::size_t last = (block.last - TEXT_SEGMENT_BEGIN) >> 2;
+        const std::size_t branch = get_branch(block);
+
+        if (last + 1 < N) {
+            block.successors.push_back(b + 1);
+        }
+        if (branch < N) {
+            block.bubbles = get_branch_bubbles();
+
+            const std::int64_t target = get_target(branch, machine_codes[branch]);
+            if (
+                0 <= target && target < std::int64_t(N) &&
+                block.successors.end() == std::find(block.successors.begin(), block.successors.end(), block_index[target])
+            ) {
+                block.successors.push_back(block_index[target]);
+            }
+        }
+    }
+}
+
+/**
+    Predict stall cycles of every instruction, along fall-through path & behind each branch to its target.
+*/
+void StaticTiming::predict_stalls(void) {
+    const std::size_t N = machine_codes.size();
+
+    // a. fall-through path:
+    Scheduler::Timeline timeline(DELAY_SLOT);
+    stalls.resize(N);
+    fall_through_stalls = 0;
+    fall_through_bubbles = 0;
+    for (std::size_t i = 0; i < N; ++i) {
+        stalls[i] = timeline.decode(machine_codes[i]);
+        fall_through_stalls = add_stalls(fall_through_stalls, stalls[i]);
+        if (is_branch(machine_codes[i])) {
+            fall_through_bubbles += get_branch_bubbles();
+        }
+    }
+
+    // b. branch targets -- entered behind the branch & its delay slot, no producer further up is left within reach:
+    std::vector<std::size_t> block_index(N);
+    for (std::size_t b = 0; b < blocks.size(); ++b) {
+        const std::size_t first = (blocks[b].first - TEXT_SEGMENT_BEGIN) >> 2;
+        std::fill(block_index.begin() + first, block_index.begin() + first + blocks[b].num_instructions, b);
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+        const std::int64_t target = get_target(i, machine_codes[i]);
+        if (!is_branch(machine_codes[i]) || target < 0 || std::int64_t(N) <= target) {
+            continue;
+        }
+
+        const Block &block = blocks[block_index[target]];
+        Scheduler::Timeline entry(DELAY_SLOT);
+        entry.decode(machine_codes[i]);
+        if (DELAY_SLOT && i + 1 < N) {
+            entry.decode(machine_codes[i + 1]);
+        }
+        for (std::size_t j = target; j < std::size_t(target) + block.num_instructions; ++j) {
+            stalls[j] = std::max(stalls[j], entry.decode(machine_codes[j]));
+        }
+    }
+
+    // c. worst over entries:
+    for (Block &block: blocks) {
+        const std::size_t first = (block.first - TEXT_SEGMENT_BEGIN) >> 2;
+        for (std::size_t i = first; i < first + block.num_instructions; ++i) {
+            block.stalls = add_stalls(block.stalls, stalls[i]);
+        }
+    }
+}
+
+/**
+    Find natural loops of backward branches & predict one iteration each.
+*/
+void StaticTiming::find_loops(void) {
+    for (std::size_t b = 0; b < blocks.size(); ++b) {
+        const std::size_t last = (blocks[b].last - TEXT_SEGMENT_BEGIN) >> 2;
+        const std::size_t branch = get_branch(blocks[b]);
+        if (machine_codes.size() == branch) {
+            continue;
+        }
+        const std::int64_t target = get_target(branch, machine_codes[branch]);
+        if (target < 0 || std::int64_t(branch) < target) {
+            continue;
+        }
+
+        // a. header -- block starting at branch target:
+        std::size_t header = b;
+        while (TEXT_SEGMENT_BEGIN + ISA::Address(target << 2) != blocks[header].first) {
+            --header;
+        }
+
+        // b. one iteration, entered behind the backward branch & its delay slot:
+        Loop loop = {header, b, 0, 0, 0};
+        Scheduler::Timeline timeline(DELAY_SLOT);
+        timeline.decode(machine_codes[branch]);
+        if (DELAY_SLOT && branch + 1 < machine_codes.size()) {
+            timeline.decode(machine_codes[branch + 1]);
+        }
+        for (std::size_t i = target; i <= last; ++i) {
+            loop.stalls = add_stalls(loop.stalls, timeline.decode(machine_codes[i]));
+            if (is_branch(machine_codes[i])) {
+                loop.bubbles += get_branch_bubbles();
+            }
+            ++loop.num_instructions;
+        }
+
+        loops.push_back(loop);
+    }
+}
+
+/**
+    Get predicted clock cycles of a complete run with every branch falling through, DEADLOCK if it never completes.
+*/
+std::uint64_t StaticTiming::get_fall_through_cycles(void) const {
+    return get_cycles(machine_codes.size(), fall_through_stalls, fall_through_bubbles + FILL_DRAIN);
+}
+
+/**
+    Dump timing report -- fall-through path, basic blocks, loops & instruction image annotated with stall cycles.
+
+    @param output output stream.
+*/
+void StaticTiming::dump(std::ostream &output) {
+    // a. fall-through path:
+    output << std::dec;
+    output << "# instructions: " << machine_codes.size() << ", basic blocks: " << blocks.size() << ", loops: " << loops.size();
+    output << (DELAY_SLOT ? ", branch delay slots" : "") << std::endl;
+    output << "# fall-through path -- data hazard stall cycles: " << to_cycles(fall_through_stalls);
+    output << ", branch bubbles: " << fall_through_bubbles << ", clock cycles: " << to_cycles(get_fall_through_cycles()) << std::endl;
+
+    // b. basic blocks:
+    output << std::endl << "# basic blocks" << std::endl;
+    output << "#    block       first        last  instructions    stalls   bubbles    cycles\tsuccessors" << std::endl;
+    for (std::size_t b = 0; b < blocks.size(); ++b) {
+        const Block &block = blocks[b];
+
+        output << std::setfill(' ') << std::dec << std::setw(10) << b;
+        output << "  " << to_hex(block.first) << "  " << to_hex(block.last);
+        output << std::setw(14) << block.num_instructions << std::setw(10) << to_cycles(block.stalls) << std::setw(10) << block.bubbles;
+        output << std::setw(10) << to_cycles(get_cycles(block.num_instructions, block.stalls, block.bubbles)) << "\t";
+        for (std::size_t i = 0; i < block.successors.size(); ++i) {
+            output << ((0 == i) ? "" : " ") << block.successors[i];
+        }
+        output << std::endl;
+    }
+
+    // c. loops, one iteration each:
+    output << std::endl << "# loops" << std::endl;
+    output << "#   header       first       latch        last  instructions    stalls   bubbles    cycles" << std::endl;
+    for (const Loop &loop: loops) {
+        output << std::setfill(' ') << std::dec << std::setw(10) << loop.header << "  " << to_hex(blocks[loop.header].first);
+        output << std::setw(12) << loop.latch << "  " << to_hex(blocks[loop.latch].last);
+        output << std::setw(14) << loop.num_instructions << std::setw(10) << to_cycles(loop.stalls) << std::setw(10) << loop.bubbles;
+        output << std::setw(10) << to_cycles(get_cycles(loop.num_instructions, loop.stalls, loop.bubbles)) << std::endl;
+    }
+
+    // d. annotated instruction image:
+    output << std::endl << "# address: machine code     block    stalls\tsource" << std::endl;
+    std::size_t b = 0;
+    for (std::size_t i = 0; i < machine_codes.size(); ++i) {
+        const ISA::Address address = TEXT_SEGMENT_BEGIN + (i << 2);
+        if (blocks[b].last < address) {
+            ++b;
+        }
+
+        output << to_hex(address) << ": " << to_hex(machine_codes[i]) << ";";
+        output << std::setfill(' ') << std::dec << std::setw(10) << b << std::setw(10) << to_cycles(stalls[i]);
+        output << "\t" << text_segment.get_text(address) << std::endl;
+    }
+}
+
+/**
+    Fill JSON timing report.
+
+    @param report output JSON report.
+*/
+void StaticTiming::report(nlohmann::json &report) const {
+    const auto cycles = [](std::uint64_t value) {
+        return (Scheduler::DEADLOCK == value) ? nlohmann::json("deadlock") : nlohmann::json(value);
+    };
+
+    // a. fall-through path:
+    report["branch delay slots"] = DELAY_SLOT;
+    report["fall-through path"] = {
+        {"instructions", machine_codes.size()},
+        {"stall cycles", cycles(fall_through_stalls)},
+        {"branch bubbles", fall_through_bubbles},
+        {"clock cycles", cycles(get_fall_through_cycles())}
+    };
+
+    // b. basic blocks:
+    report["basic blocks"] = nlohmann::json::array();
+    for (const Block &block: blocks) {
+        report["basic blocks"].push_back({
+            {"first", to_hex(block.first)},
+            {"last", to_hex(block.last)},
+            {"instructions", block.num_instructions},
+            {"stall cycles", cycles(block.stalls)},
+            {"branch bubbles", block.bubbles},
+            {"clock cycles", cycles(get_cycles(block.num_instructions, block.stalls, block.bubbles))},
+            {"successors", block.successors}
+        });
+    }
+
+    // c. loops, one iteration each:
+    report["loops"] = nlohmann::json::array();
+    for (const Loop &loop: loops) {
+        report["loops"].push_back({
+            {"header", to_hex(blocks[loop.header].first)},
+            {"latch", to_hex(blocks[loop.latch].last)},
+            {"instructions", loop.num_instructions},
+            {"stall cycles", cycles(loop.stalls)},
+            {"branch bubbles", loop.bubbles},
+            {"clock cycles", cycles(get_cycles(loop.num_instructions, loop.stalls, loop.bubbles))}
+        });
+    }
+}
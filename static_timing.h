@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "isa.h"
+#include "json.h"
+
+/**
+ *  Static pipeline timing analysis -- control flow graph of a text segment, with data hazard stalls
+ *  & branch bubbles of every basic block & loop predicted by the hazard model of the Scheduler,
+ *  without executing the program.
+ */
+class StaticTiming {
+public:
+    // clock cycles of pipeline fill & drain in a complete run:
+    static const std::uint64_t FILL_DRAIN = 4;
+    // fetch bubbles behind each branch, IF waits until it reaches EX/MEM, none with delay slots:
+    static const std::uint64_t BRANCH_BUBBLES = 1;
+
+    struct Block {
+        ISA::Address first;
+        ISA::Address last;
+        std::size_t num_instructions;
+        // data hazard stall cycles, worst over fall-through & branch entries, DEADLOCK if the executor never gets through:
+        std::uint64_t stalls;
+        std::uint64_t bubbles;
+        // successor blocks, fall-through first, past the end of text segment left out:
+        std::vector<std::size_t> successors;
+    };
+
+    /*
+        natural loop -- blocks from branch target header down to the backward branch
+     */
+    struct Loop {
+        std::size_t header;
+        std::size_t latch;
+        std::size_t num_instructions;
+        // per iteration, entered through the backward branch with inner branches falling through:
+        std::uint64_t stalls;
+        std::uint64_t bubbles;
+    };
+
+    /**
+        @param text analyzed text segment.
+        @param delay_slot true when the instruction behind each branch always executes, as the last of its block.
+    */
+    StaticTiming(ISA::TextSegment &text, bool delay_slot = false);
+
+    const std::vector<Block> &get_blocks(void) const {return blocks;}
+    const std::vector<Loop> &get_loops(void) const {return loops;}
+
+    /**
+        Get predicted clock cycles of a complete run with every branch falling through, DEADLOCK if it never completes.
+    */
+    std::uint64_t get_fall_through_cycles(void) const;
+
+    /**
+        Dump timing report -- fall-through path, basic blocks, loops & instruction image annotated with stall cycles.
+
+        @param output output stream.
+    */
+    void dump(std::ostream &output);
+
+    /**
+        Fill JSON timing report.
+
+        @param report output JSON report.
+    */
+    void report(nlohmann::json &report) const;
+private:
+    ISA::TextSegment &text_segment;
+    const ISA::Address TEXT_SEGMENT_BEGIN;
+    const bool DELAY_SLOT;
+
+    std::vector<ISA::MachineCode> machine_codes;
+    // predicted stall cycles of each instruction, worst over entries of its block:
+    std::vector<std::uint64_t> stalls;
+    // along fall-through path:
+    std::uint64_t fall_through_stalls;
+    std::uint64_t fall_through_bubbles;
+
+    std::vector<Block> blocks;
+    std::vector<Loop> loops;
+
+    /**
+        Get fetch bubbles behind each branch.
+    */
+    std::uint64_t get_branch_bubbles(void) const {return DELAY_SLOT ? 0 : BRANCH_BUBBLES;}
+
+    /**
+        Get index of branch ending block, number of instructions if it ends without one.
+
+        @param block basic block.
+    */
+    std::size_t get_branch(const Block &block) const;
+
+    /**
+        Split text segment into basic blocks & link them.
+    */
+    void build_blocks(void);
+
+    /**
+        Predict stall cycles of every instruction, along fall-through path & behind each branch to its target.
+    */
+    void predict_stalls(void);
+
+    /**
+        Find natural loops of backward branches & predict one iteration each.
+    */
+    void find_loops(void);
+};
@@ -0,0 +1,103 @@
+/**
+    statictiming.cpp
+    Purpose: Predict pipeline timing of MIPS ASM or program image statically, without execution
+
+    @version 1.0
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include "assembler.h"
+#include "program_image.h"
+#include "static_timing.h"
+
+namespace po = boost::program_options;
+
+int main(int argc, char* argv[]) {
+    std::string input, output_filename, report_filename;
+    bool schedule, delay_slot, fill_delay_slots;
+
+    try {
+        // set parser:
+        po::options_description desc("MIPS static timing usage");
+        desc.add_options()
+          ("help",    "produce help message")
+          ("input",   po::value<std::string>(&input)->required(),  "set input ASM or binary program image")
+          ("output",  po::value<std::string>(&output_filename),    "set timing report output file, stdout by default")
+          ("report",  po::value<std::string>(&report_filename),    "set JSON timing report output file")
+          ("schedule", po::bool_switch(&schedule),                 "reorder independent instructions inside basic blocks before analysis")
+          ("delay-slot", po::bool_switch(&delay_slot),             "model branch delay slots, the instruction behind each branch always executes")
+          ("fill-delay-slots", po::bool_switch(&fill_delay_slots), "insert a delay slot behind every branch before analysis, filled where safe")
+        ;
+
+        // parse arguments:
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << "\n";
+            return 0;
+        }
+        po::notify(vm);
+
+        if (fill_delay_slots && !delay_slot) {
+            throw std::runtime_error("fill-delay-slots requires --delay-slot");
+        }
+    }
+    catch(std::exception& e) {
+        std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << "\n";
+        return 1;
+    }
+
+    try {
+        // a. text segment, assembled or loaded:
+        ISA::TextSegment text_segment;
+        if (ProgramImage::is_image(input)) {
+            text_segment = ProgramImageReader(input).get_text_segment();
+        } else {
+            Assembler assembler(input, 0x00400000, 1, schedule, fill_delay_slots);
+            // errors already reported by the assembler, a partially encoded program is not analyzed:
+            if (0 != assembler.get_num_errors()) {
+                throw std::runtime_error("cannot assemble input ASM file " + input + " -- " + std::to_string(assembler.get_num_errors()) + " error(s)");
+            }
+            text_segment = assembler.get_text_segment();
+        }
+        if (text_segment.is_empty()) {
+            throw std::runtime_error("no instructions in input " + input);
+        }
+
+        // b. analysis:
+        StaticTiming timing(text_segment, delay_slot);
+
+        if (output_filename.empty()) {
+            timing.dump(std::cout);
+        } else {
+            std::ofstream output(output_filename);
+            if (!output) {
+                throw std::runtime_error("cannot open output timing report file " + output_filename);
+            }
+            timing.dump(output);
+        }
+
+        if (!report_filename.empty()) {
+            std::ofstream output(report_filename);
+            if (!output) {
+                throw std::runtime_error("cannot open output JSON timing report file " + report_filename);
+            }
+
+            nlohmann::json report;
+            timing.report(report);
+            output << report.dump(4) << std::endl;
+        }
+    }
+    catch(std::runtime_error& e) {
+        std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include "sweep.h"
+
+#include <iostream>
+#include <fstream>
+#include <set>
+#include <cctype>
+#include <stdexcept>
+#include <thread>
+
+#include "json.h"
+#include "host_timer.h"
+
+SweepSimulator::SweepSimulator(
+    ISA::TextSegment &text,
+    ISA::DataSegment &data,
+    const std::vector<TimingConfig> &configs,
+    std::size_t queue_capacity
+): functional(text, data) {
+    for (const auto &config: configs) {
+        queues.emplace_back(new SPSCQueue<DynamicInstruction>(queue_capacity));
+        timings.emplace_back(new TimingModel(text, *queues.back(), config));
+    }
+}
+
+/**
+    Load timing configurations from JSON file holding an array of configurations.
+
+    @param input_filename input JSON filename.
+*/
+std::vector<TimingConfig> SweepSimulator::load_configs(const std::string &input_filename) {
+    std::ifstream input(input_filename);
+
+    if (!input) {
+        throw std::runtime_error("cannot open input sweep configuration file " + input_filename);
+    }
+
+    nlohmann::json configs;
+    try {
+        input >> configs;
+    } catch (const std::exception &e) {
+        throw std::runtime_error("invalid sweep configuration file " + input_filename + " -- " + e.what());
+    }
+
+    if (!configs.is_array() || configs.empty()) {
+        throw std::runtime_error("invalid sweep configuration file " + input_filename + " -- non-empty array expected");
+    }
+
+    std::vector<TimingConfig> result;
+    std::set<std::string> names;
+    for (const auto &config: configs) {
+        result.push_back(TimingConfig::from_json(config));
+
+        // names become report filenames:
+        const std::string &name = result.back().name;
+        bool is_safe = !name.empty();
+        for (const char c: name) {
+            is_safe = is_safe && (std::isalnum(static_cast<unsigned char>(c)) || '-' == c || '_' == c || '.' == c);
+        }
+        if (!is_safe) {
+            throw std::runtime_error("invalid timing configuration name \"" + name + "\" -- letters, digits, '-', '_' & '.' ONLY");
+        }
+        if (!names.insert(name).second) {
+            throw std::runtime_error("duplicate timing configuration name " + name);
+        }
+    }
+
+    return result;
+}
+
+/**
+    Run program through all timing models in a single functional pass.
+
+    @param MODE execution mode.
+    @param N execution time.
+*/
+void SweepSimulator::run(const std::string &MODE, const int N) {
+    const int max_instructions = ("instruction" == MODE) ? N : -1;
+
+    // timing back-ends:
+    std::vector<std::thread> back_ends;
+    for (auto &timing: timings) {
+        TimingModel *model = timing.get();
+        back_ends.emplace_back(
+            [model, &MODE, N]() {
+                model->run(MODE, N);
+            }
+        );
+    }
+
+    // functional front-end:
+    std::vector<SPSCQueue<DynamicInstruction>*> streams;
+    for (auto &queue: queues) {
+        streams.push_back(queue.get());
+    }
+    functional.run(streams, max_instructions);
+
+    for (auto &back_end: back_ends) {
+        back_end.join();
+    }
+}
+
+/**
+    Get total number of instructions of last run, summed over all timing models.
+*/
+std::int64_t SweepSimulator::get_total_instructions(void) const {
+    std::int64_t result = 0;
+
+    for (const auto &timing: timings) {
+        result += timing->get_total_instructions();
+    }
+
+    return result;
+}
+
+/**
+    Dump one resource utilization report per timing model, named
+    [output_prefix]--[configuration name].json
+
+    @param output_prefix output filename prefix.
+*/
+void SweepSimulator::dump(const std::string &output_prefix) {
+    HOST_TIMER(REPORT_DUMP);
+
+    for (auto &timing: timings) {
+        const std::string output_filename = output_prefix + "--" + timing->get_config().name + ".json";
+        std::ofstream output(output_filename);
+
+        if(!output) {
+            std::cerr << "[MIPS simulator]: ERROR -- cannot open output resource utilization file "<< output_filename <<std::endl;
+            continue;
+        }
+
+        nlohmann::json execution_report;
+
+        execution_report["configuration"] = timing->get_config().to_json();
+        execution_report["resource utilization"] = {};
+        timing->report(execution_report["resource utilization"]);
+
+        output << execution_report.dump(4) << std::endl;
+
+        // close output file:
+        output.close();
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "isa.h"
+#include "spsc_queue.h"
+#include "dynamic_instruction.h"
+#include "functional.h"
+#include "timing.h"
+
+/**
+ *  Configuration sweep -- one functional pass broadcasts its dynamic instruction
+ *  stream to K timing models, each running on its own thread.
+ */
+class SweepSimulator {
+public:
+    SweepSimulator(
+        ISA::TextSegment &text, ISA::DataSegment &data,
+        const std::vector<TimingConfig> &configs,
+        std::size_t queue_capacity = 4096
+    );
+
+    /**
+        Load timing configurations from JSON file holding an array of configurations.
+
+        @param input_filename input JSON filename.
+    */
+    static std::vector<TimingConfig> load_configs(const std::string &input_filename);
+
+    /**
+        Run program through all timing models in a single functional pass.
+
+        @param MODE execution mode.
+        @param N execution time.
+    */
+    void run(const std::string &MODE, const int N);
+
+    /**
+        Get total number of instructions of last run, summed over all timing models.
+    */
+    std::int64_t get_total_instructions(void) const;
+
+    /**
+        Dump one resource utilization report per timing model, named
+        [output_prefix]--[configuration name].json
+
+        @param output_prefix output filename prefix.
+    */
+    void dump(const std::string &output_prefix);
+private:
+    std::vector<std::unique_ptr<SPSCQueue<DynamicInstruction>>> queues;
+    std::vector<std::unique_ptr<TimingModel>> timings;
+    FunctionalSimulator functional;
+};
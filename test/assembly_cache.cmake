@@ -0,0 +1,25 @@
+# syntax errors are reported on every run with --cache, never stored as a cache hit:
+#   cmake -DMAIN=path/to/main -DWORK_DIR=scratch/dir -P assembly_cache.cmake
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR})
+file(WRITE ${WORK_DIR}/error.asm "addi $t0 $zero 0x0001\nbadop $t0\n")
+
+foreach(run 1 2)
+    execute_process(
+        COMMAND ${MAIN} --input ${WORK_DIR}/error.asm --mode instruction --number 10 --trace off
+                --cache ${WORK_DIR}/cache --image ${WORK_DIR}/error.img --output-dir ${WORK_DIR}/output
+        ERROR_VARIABLE errors
+        OUTPUT_QUIET
+    )
+    if(NOT errors MATCHES "syntax error at line 2")
+        message(FATAL_ERROR "run ${run} did not report the syntax error:\n${errors}")
+    endif()
+    if(errors MATCHES "assembly cache hit")
+        message(FATAL_ERROR "run ${run} loaded a cached image of a program with syntax errors")
+    endif()
+endforeach()
+
+if(EXISTS ${WORK_DIR}/error.img)
+    message(FATAL_ERROR "program image of a program with syntax errors was written")
+endif()
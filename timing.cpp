@@ -0,0 +1,502 @@
+#include "timing.h"
+
+#include <stdexcept>
+
+#include "host_timer.h"
+
+namespace {
+    typedef bool (nlohmann::json::*TypeCheck)(void) const noexcept;
+
+    /**
+        Check type of optional configuration key.
+
+        @param object JSON object.
+        @param key key name.
+        @param is_valid type predicate.
+        @param expected expected type, for error message.
+    */
+    void check_key(const nlohmann::json &object, const std::string &key, TypeCheck is_valid, const std::string &expected) {
+        if (object.count(key) && !(object[key].*is_valid)()) {
+            throw std::runtime_error("\"" + key + "\" must be " + expected);
+        }
+    }
+}
+
+/**
+    Parse & validate configuration, missing keys keep their defaults.
+
+    @param config JSON configuration.
+*/
+TimingConfig TimingConfig::from_json(const nlohmann::json &config) {
+    TimingConfig result;
+
+    if (!config.is_object()) {
+        throw std::runtime_error("invalid timing configuration -- JSON object expected");
+    }
+
+    // a. name first, for error messages:
+    try {
+        check_key(config, "name", &nlohmann::json::is_string, "a string");
+    } catch (const std::runtime_error &e) {
+        throw std::runtime_error(std::string("invalid timing configuration -- ") + e.what());
+    }
+    result.name = config.value("name", result.name);
+
+    try {
+        // b. key types:
+        check_key(config, "forwarding", &nlohmann::json::is_boolean, "a boolean");
+        check_key(config, "branch policy", &nlohmann::json::is_string, "a string");
+        check_key(config, "predictor entries", &nlohmann::json::is_number_unsigned, "an unsigned integer");
+        check_key(config, "data cache", &nlohmann::json::is_object, "an object");
+
+        result.forwarding = config.value("forwarding", result.forwarding);
+        result.branch_policy = BranchPredictor::parse_policy(
+            config.value("branch policy", BranchPredictor::get_policy_name(result.branch_policy))
+        );
+        result.predictor_entries = config.value("predictor entries", result.predictor_entries);
+
+        if (config.count("data cache")) {
+            const nlohmann::json &dcache = config["data cache"];
+
+            check_key(dcache, "size", &nlohmann::json::is_number_unsigned, "an unsigned integer");
+            check_key(dcache, "line size", &nlohmann::json::is_number_unsigned, "an unsigned integer");
+            check_key(dcache, "ways", &nlohmann::json::is_number_unsigned, "an unsigned integer");
+            check_key(dcache, "miss penalty", &nlohmann::json::is_number_unsigned, "an unsigned integer");
+
+            result.dcache_size = dcache.value("size", result.dcache_size);
+            result.dcache_line_size = dcache.value("line size", result.dcache_line_size);
+            result.dcache_ways = dcache.value("ways", result.dcache_ways);
+            result.dcache_miss_penalty = dcache.value("miss penalty", result.dcache_miss_penalty);
+        }
+
+        // c. cache geometry & predictor entries, checked here instead of when timing models are built:
+        result.validate();
+    } catch (const std::runtime_error &e) {
+        throw std::runtime_error("invalid timing configuration " + result.name + " -- " + e.what());
+    }
+
+    return result;
+}
+
+/**
+    Check cache geometry & predictor entries, throws std::runtime_error if invalid.
+*/
+void TimingConfig::validate(void) const {
+    Cache::validate(dcache_size, dcache_line_size, dcache_ways);
+    BranchPredictor::validate(branch_policy, predictor_entries);
+}
+
+nlohmann::json TimingConfig::to_json(void) const {
+    return {
+        {"name", name},
+        {"forwarding", forwarding},
+        {"branch policy", BranchPredictor::get_policy_name(branch_policy)},
+        {"predictor entries", predictor_entries},
+        {"data cache", {
+            {"size", dcache_size},
+            {"line size", dcache_line_size},
+            {"ways", dcache_ways},
+            {"miss penalty", dcache_miss_penalty}
+        }}
+    };
+}
+
+TimingModel::TimingModel(
+    ISA::TextSegment &text,
+    SPSCQueue<DynamicInstruction> &queue,
+    const TimingConfig &config
+):
+    CONFIG(config),
+    dcache(config.dcache_size, config.dcache_line_size, config.dcache_ways),
+    predictor(config.branch_policy, config.predictor_entries),
+    text_segment(text),
+    stream(queue),
+    trace_sink(nullptr) {
+    init();
+}
+
+/**
+    Run timing simulation until the record stream drains.
+
+    @param MODE execution mode.
+    @param N execution time.
+*/
+void TimingModel::run(const std::string &MODE, const int N) {
+    // initialize pipeline:
+    init();
+
+    // initialize PC:
+    PC = text_segment.get_address_first();
+    const ISA::Address TEXT_SEGMENT_END = text_segment.get_address_last();
+
+    // execute:
+    while (DPC != TEXT_SEGMENT_END && !is_empty()) {
+        // termination check:
+        if (is_terminated(MODE, N)) {
+            break;
+        }
+
+        // dump pipeline state each cycle for better illustration:
+        if (nullptr != trace_sink) {
+            dump_pipeline_state();
+        }
+
+        // execute pipeline:
+        execute_pipeline();
+
+        // update clock cycle count:
+        monitor.total_clock_cycles += 1;
+    }
+
+    // release the functional front-end:
+    stream.cancel();
+}
+
+/**
+    Fill resource utilization report.
+
+    @param report output JSON report.
+*/
+void TimingModel::report(nlohmann::json &report) {
+    static const char *STAGE_NAME[Stage::NUM_STAGES] = {"IF", "ID", "EX", "MEM", "WB"};
+
+    report["total clock cycles"] = monitor.total_clock_cycles;
+    report["total instructions"] = monitor.total_instructions;
+    report["nop analysis"] = {};
+    for (std::size_t i = 0; i < Stage::NUM_STAGES; ++i) {
+        report["nop analysis"][STAGE_NAME[i]] = {
+            {"count", monitor.nop_count[i]}, {"percentage", (100.0 * monitor.nop_count[i]) / monitor.total_clock_cycles}
+        };
+    }
+
+    monitor.cpi_stack.report(report["CPI stack"]);
+
+    if (dcache.is_enabled()) {
+        report["data cache"] = {
+            {"accesses", dcache.get_accesses()},
+            {"misses", dcache.get_misses()},
+            {"miss rate", (0 == dcache.get_accesses()) ? 0.0 : (100.0 * dcache.get_misses()) / dcache.get_accesses()}
+        };
+    }
+    if (BranchPredictor::STALL != predictor.get_policy()) {
+        report["branch predictor"] = {
+            {"branches", predictor.get_branches()},
+            {"mispredictions", predictor.get_mispredictions()}
+        };
+    }
+}
+
+/*
+    MIPS pipeline -- instruction fetch
+*/
+void TimingModel::execute_IF() {
+    if (hazard.structural) {
+        // hold IF/ID:
+        monitor.nop_count[Stage::IF] += 1;
+        return;
+    }
+
+    if (hazard.control) {
+        if (ISA::OpCode::BEQ == EX_MEM.instruction.opcode) {
+            // control hazard resolved:
+            if (EX_MEM.instruction.taken) {
+                PC = EX_MEM.instruction.next_pc;
+            }
+
+            hazard.control = false;
+        } else {
+            // insert nop:
+            IF_ID.reset();
+            IF_ID.cause = CPIStack::CONTROL;
+            monitor.nop_count[Stage::IF] += 1;
+            return;
+        }
+    }
+
+    if (hazard.data) {
+        // insert nop:
+        monitor.nop_count[Stage::IF] += 1;
+        return;
+    }
+
+    if (drained || !stream.pop(IF_ID.instruction)) {
+        // insert nop:
+        drained = true;
+        IF_ID.reset();
+        monitor.nop_count[Stage::IF] += 1;
+        return;
+    }
+
+    IF_ID.nop = false;
+
+    // update instruction count:
+    PC = IF_ID.instruction.pc + 4;
+    monitor.total_instructions += 1;
+}
+/*
+    MIPS pipeline -- instruction decoding
+*/
+void TimingModel::execute_ID() {
+    if (hazard.structural) {
+        // hold IF/ID & ID/EX:
+        monitor.nop_count[Stage::ID] += 1;
+        return;
+    }
+
+    if (IF_ID.nop) {
+        // insert nop:
+        ID_EX.reset();
+        ID_EX.cause = IF_ID.cause;
+        monitor.nop_count[Stage::ID] += 1;
+        return;
+    }
+
+    const DynamicInstruction &instruction = IF_ID.instruction;
+
+    // data hazard detected, charged to the nearest producer:
+    if (CONFIG.forwarding) {
+        // only load-use remains, re-evaluated each cycle:
+        hazard.data = (
+            EX_MEM.instruction.is_load && EX_MEM.WriteRegAddr != 0x0 &&
+            (EX_MEM.WriteRegAddr == instruction.rs || EX_MEM.WriteRegAddr == instruction.rt)
+        );
+        hazard.data_cause = CPIStack::DATA_LOAD;
+    } else if (
+        (EX_MEM.WriteRegAddr != 0x0 && EX_MEM.WriteRegAddr == instruction.rs) ||
+        (EX_MEM.WriteRegAddr != 0x0 && EX_MEM.WriteRegAddr == instruction.rt)
+    ) {
+        hazard.data = true;
+        hazard.data_cause = CPIStack::get_data_cause(EX_MEM.instruction.ir);
+    } else if (
+        (MEM_WB.WriteRegAddr != 0x0 && MEM_WB.WriteRegAddr == instruction.rs) ||
+        (MEM_WB.WriteRegAddr != 0x0 && MEM_WB.WriteRegAddr == instruction.rt)
+    ) {
+        hazard.data = true;
+        hazard.data_cause = CPIStack::get_data_cause(MEM_WB.instruction.ir);
+    }
+
+    // control hazard detected, unless correctly predicted:
+    if (ISA::OpCode::BEQ == instruction.opcode) {
+        if (BranchPredictor::STALL == CONFIG.branch_policy) {
+            hazard.control = true;
+        } else if (!hazard.data && !predictor.predict(instruction.pc, instruction.taken)) {
+            hazard.control = true;
+        }
+    }
+
+    if (hazard.data) {
+        ID_EX.reset();
+        ID_EX.cause = hazard.data_cause;
+        monitor.nop_count[Stage::ID] += 1;
+        return;
+    }
+
+    ID_EX.nop = false;
+    ID_EX.instruction = instruction;
+    ID_EX.WriteRegAddr = (ISA::OpCode::R_COMMON == instruction.opcode) ? instruction.rd : instruction.rt;
+}
+/*
+    MIPS pipeline -- execution
+*/
+void TimingModel::execute_EX() {
+    if (hazard.structural) {
+        // hold ID/EX & EX/MEM:
+        monitor.nop_count[Stage::EX] += 1;
+        return;
+    }
+
+    if (ID_EX.nop) {
+        EX_MEM.reset();
+        EX_MEM.cause = ID_EX.cause;
+        monitor.nop_count[Stage::EX] += 1;
+        return;
+    }
+
+    EX_MEM = ID_EX;
+}
+/*
+    MIPS pipeline -- memory access
+*/
+void TimingModel::execute_MEM() {
+    if (EX_MEM.nop) {
+        MEM_WB.reset();
+        MEM_WB.cause = EX_MEM.cause;
+        monitor.nop_count[Stage::MEM] += 1;
+        return;
+    }
+
+    // data cache access, stall MEM on miss:
+    if (
+        dcache.is_enabled() && !mem_pending &&
+        (EX_MEM.instruction.is_load || EX_MEM.instruction.is_store) &&
+        !dcache.access(EX_MEM.instruction.mem_address)
+    ) {
+        mem_pending = true;
+        mem_stall = CONFIG.dcache_miss_penalty;
+    }
+    if (0 < mem_stall) {
+        mem_stall -= 1;
+        hazard.structural = true;
+        MEM_WB.reset();
+        MEM_WB.cause = CPIStack::STRUCTURAL;
+        monitor.nop_count[Stage::MEM] += 1;
+        return;
+    }
+    mem_pending = false;
+    hazard.structural = false;
+
+    MEM_WB.nop = false;
+    MEM_WB.instruction = EX_MEM.instruction;
+
+    switch (EX_MEM.instruction.opcode) {
+        case ISA::OpCode::R_COMMON:
+        case ISA::OpCode::ADDI:
+        case ISA::OpCode::ANDI:
+        case ISA::OpCode::ORI:
+        case ISA::OpCode::SLTI:
+        case ISA::OpCode::SLTIU:
+        case ISA::OpCode::LUI:
+            MEM_WB.WriteRegAddr = EX_MEM.WriteRegAddr;
+            monitor.nop_count[Stage::MEM] += 1;
+            break;
+        case ISA::OpCode::LW:
+            MEM_WB.WriteRegAddr = EX_MEM.WriteRegAddr;
+            break;
+        case ISA::OpCode::SW:
+            MEM_WB.WriteRegAddr = 0x00000000;
+            break;
+        default:
+            MEM_WB.WriteRegAddr = 0x00000000;
+            monitor.nop_count[Stage::MEM] += 1;
+            break;
+    }
+}
+/*
+    MIPS pipeline -- write back
+*/
+void TimingModel::execute_WB() {
+    if (MEM_WB.nop) {
+        monitor.nop_count[Stage::WB] += 1;
+        monitor.cpi_stack.bubble(MEM_WB.cause);
+        return;
+    }
+
+    monitor.cpi_stack.retire();
+
+    const DynamicInstruction &instruction = MEM_WB.instruction;
+    bool write = false;
+
+    switch (instruction.opcode) {
+        case ISA::OpCode::R_COMMON:
+            switch (instruction.funct) {
+                case ISA::Funct::ADD:
+                case ISA::Funct::SUB:
+                case ISA::Funct::AND:
+                case ISA::Funct::OR:
+                case ISA::Funct::SLL:
+                case ISA::Funct::SRL:
+                    write = (0x0 != MEM_WB.WriteRegAddr);
+                    break;
+                case ISA::Funct::MUL:
+                    // writes both rd & rd + 1:
+                    write = true;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case ISA::OpCode::ADDI:
+        case ISA::OpCode::ANDI:
+        case ISA::OpCode::ORI:
+        case ISA::OpCode::SLTI:
+        case ISA::OpCode::SLTIU:
+        case ISA::OpCode::LUI:
+        case ISA::OpCode::LW:
+            write = (0x0 != MEM_WB.WriteRegAddr);
+            break;
+        default:
+            monitor.nop_count[Stage::WB] += 1;
+            break;
+    }
+
+    // resolve data hazard:
+    if (write) {
+        hazard.data = false;
+    }
+
+    DPC = instruction.pc;
+}
+
+/**
+    Run pipeline in reverse order to eliminate the need of intermediate buffer
+*/
+void TimingModel::execute_pipeline(void) {
+    execute_WB();
+    execute_MEM();
+    execute_EX();
+    execute_ID();
+    execute_IF();
+}
+
+void TimingModel::init(void) {
+    IF_ID.reset();
+    ID_EX.reset();
+    EX_MEM.reset();
+    MEM_WB.reset();
+    hazard.reset();
+    monitor.reset();
+
+    PC = DPC = 0x00000000;
+    drained = false;
+
+    mem_stall = 0;
+    mem_pending = false;
+    dcache.reset();
+    predictor.reset();
+}
+
+bool TimingModel::is_terminated(const std::string &MODE, const int N) {
+    bool result = false;
+
+    if (
+        ("instruction" == MODE && monitor.total_instructions >= N ) ||
+        ("cycle" == MODE && monitor.total_clock_cycles >= N)
+    ) {
+        result = true;
+    }
+
+    return result;
+}
+
+bool TimingModel::is_empty(void) {
+    return drained && IF_ID.nop && ID_EX.nop && EX_MEM.nop && MEM_WB.nop;
+}
+
+void TimingModel::dump_pipeline_state(void) {
+    HOST_TIMER(TRACE_OUTPUT);
+
+    PipelineSnapshot snapshot;
+
+    // clock cycle:
+    snapshot.cycle = monitor.total_clock_cycles;
+    // pipeline state:
+    snapshot.pc[Stage::IF] = PC;
+    snapshot.pc[Stage::ID] = IF_ID.instruction.pc;
+    snapshot.pc[Stage::EX] = ID_EX.instruction.pc;
+    snapshot.pc[Stage::MEM] = EX_MEM.instruction.pc;
+    snapshot.pc[Stage::WB] = MEM_WB.instruction.pc;
+    // bubbles:
+    snapshot.nop = (
+        ((PC < text_segment.get_address_first() || PC > text_segment.get_address_last()) << Stage::IF) |
+        (IF_ID.nop << Stage::ID) | (ID_EX.nop << Stage::EX) | (EX_MEM.nop << Stage::MEM) | (MEM_WB.nop << Stage::WB)
+    );
+    // hazards:
+    snapshot.hazard = (
+        (hazard.data ? PipelineTrace::Hazard::DATA : 0x00) |
+        (hazard.control ? PipelineTrace::Hazard::CONTROL : 0x00) |
+        (hazard.structural ? PipelineTrace::Hazard::STRUCTURAL : 0x00)
+    );
+    snapshot.reserved = 0x0000;
+
+    trace_sink->record(snapshot);
+}
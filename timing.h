@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cinttypes>
+#include <string>
+
+#include "isa.h"
+#include "json.h"
+#include "spsc_queue.h"
+#include "dynamic_instruction.h"
+#include "cache.h"
+#include "branch_predictor.h"
+#include "trace_sink.h"
+#include "cpi_stack.h"
+
+/**
+ *  Timing model configuration. Defaults reproduce the pipelined executor.
+ */
+struct TimingConfig {
+    std::string name;
+    // forward EX/MEM & MEM/WB results to ID, leaving only load-use stalls:
+    bool forwarding;
+    // branch handling:
+    BranchPredictor::Policy branch_policy;
+    std::size_t predictor_entries;
+    // data cache, size 0 for perfect memory:
+    std::size_t dcache_size;
+    std::size_t dcache_line_size;
+    std::size_t dcache_ways;
+    std::int32_t dcache_miss_penalty;
+
+    TimingConfig():
+        name("baseline"), forwarding(false),
+        branch_policy(BranchPredictor::STALL), predictor_entries(64),
+        dcache_size(0), dcache_line_size(16), dcache_ways(1), dcache_miss_penalty(10) {}
+
+    /**
+        Parse & validate configuration, missing keys keep their defaults. Throws std::runtime_error
+        naming the configuration on wrong-typed keys or invalid cache & predictor settings.
+
+        @param config JSON configuration.
+    */
+    static TimingConfig from_json(const nlohmann::json &config);
+
+    /**
+        Check cache geometry & predictor entries, throws std::runtime_error if invalid.
+    */
+    void validate(void) const;
+    nlohmann::json to_json(void) const;
+};
+
+/**
+ *  MIPS pipeline timing model -- replays the hazard & stall logic of Executor
+ *  over a stream of dynamic instruction records, without any datapath.
+ */
+class TimingModel {
+public:
+    TimingModel(ISA::TextSegment &text, SPSCQueue<DynamicInstruction> &queue, const TimingConfig &config = TimingConfig());
+
+    /**
+        Run timing simulation until the record stream drains.
+
+        @param MODE execution mode.
+        @param N execution time.
+    */
+    void run(const std::string &MODE, const int N);
+
+    /**
+        Set system state plot destination, nullptr to disable.
+
+        @param sink trace sink.
+    */
+    void set_trace_sink(TraceSink *sink) {trace_sink = sink;}
+
+    const TimingConfig &get_config(void) const {return CONFIG;}
+    std::int32_t get_total_instructions(void) const {return monitor.total_instructions;}
+
+    /**
+        Get number of records retired at WB in last run, fetched ones still in flight left out.
+    */
+    std::uint64_t get_retired_instructions(void) const {return monitor.cpi_stack.get_base();}
+
+    /**
+        Fill resource utilization report, plus cache & predictor statistics for non-baseline configurations.
+
+        @param report output JSON report.
+    */
+    void report(nlohmann::json &report);
+private:
+    /*
+        pipeline
+     */
+    enum Stage {
+        IF = 0,
+        ID = 1,
+        EX = 2,
+        MEM = 3,
+        WB = 4,
+        NUM_STAGES = 5
+    };
+
+    // pipeline latch, carries record instead of datapath values:
+    struct Latch {
+        bool nop;
+
+        DynamicInstruction instruction;
+        std::int32_t WriteRegAddr;
+        // CPIStack::Cause of bubble:
+        std::uint8_t cause;
+
+        void reset(void) {
+            nop = true;
+            instruction = DynamicInstruction();
+            WriteRegAddr = 0x00000000;
+            cause = CPIStack::DRAIN;
+        }
+    };
+    Latch IF_ID, ID_EX, EX_MEM, MEM_WB;
+
+    // hazard
+    struct {
+        bool data;
+        bool control;
+        // MEM stage busy on data cache miss:
+        bool structural;
+        // CPIStack::Cause of data hazard stalls, by producer:
+        std::uint8_t data_cause;
+
+        void reset(void) {
+            data = control = structural = false;
+            data_cause = CPIStack::DATA_ALU;
+        }
+    } hazard;
+    // remaining data cache miss penalty:
+    std::int32_t mem_stall;
+    bool mem_pending;
+
+    // monitor:
+    struct {
+        // total number of clock cycles:
+        std::int32_t total_clock_cycles;
+        // total number of instructions:
+        std::int32_t total_instructions;
+        // utilization:
+        std::int32_t nop_count[Stage::NUM_STAGES];
+        // cycles by stall cause:
+        CPIStack cpi_stack;
+
+        void reset(void) {
+            total_clock_cycles = total_instructions = 0;
+            for (std::size_t i = 0; i < Stage::NUM_STAGES; ++i) {
+                nop_count[i] = 0;
+            }
+            cpi_stack.reset();
+        }
+    } monitor;
+
+    ISA::Address PC;
+    ISA::Address DPC;
+    bool drained;
+
+    const TimingConfig CONFIG;
+    Cache dcache;
+    BranchPredictor predictor;
+
+    ISA::TextSegment &text_segment;
+    SPSCQueue<DynamicInstruction> &stream;
+    TraceSink *trace_sink;
+
+    void execute_IF();
+    void execute_ID();
+    void execute_EX();
+    void execute_MEM();
+    void execute_WB();
+
+    void init(void);
+    bool is_terminated(const std::string &MODE, const int N);
+    bool is_empty(void);
+    void execute_pipeline(void);
+    void dump_pipeline_state(void);
+};
@@ -0,0 +1,132 @@
+/**
+    trace2text.cpp
+    Purpose: Convert binary or packed pipeline trace into system state plot text
+
+    @version 1.0
+*/
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <algorithm>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "pipeline_trace.h"
+#include "packed_trace.h"
+
+namespace po = boost::program_options;
+
+/**
+    Check whether input trace is packed.
+
+    @param input_trace input trace filename.
+*/
+bool is_packed(const std::string &input_trace) {
+    char magic[sizeof(PackedTrace::MAGIC)] = {0};
+
+    std::FILE *input = std::fopen(input_trace.c_str(), "rb");
+    if (nullptr != input) {
+        std::fread(magic, 1, sizeof(magic), input);
+        std::fclose(input);
+    }
+
+    return std::equal(magic, magic + sizeof(magic), PackedTrace::MAGIC);
+}
+
+/**
+    Write rendered text once it gets large.
+
+    @param text rendered text, cleared once written.
+    @param output output stream.
+    @param force write regardless of size.
+*/
+void flush(std::string &text, std::FILE *output, bool force = false) {
+    if (force || (1 << 20) <= text.size()) {
+        std::fwrite(text.data(), 1, text.size(), output);
+        text.clear();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string input_trace, output_text;
+    std::size_t from, count;
+
+    try {
+        // set parser:
+        po::options_description desc("MIPS trace converter usage");
+        desc.add_options()
+          ("help",    "produce help message")
+          ("input",   po::value<std::string>(&input_trace)->required(),   "set input binary or packed trace")
+          ("output",  po::value<std::string>(&output_text),               "set output text file, stdout by default")
+          ("from",    po::value<std::size_t>(&from)->default_value(0),    "set first clock cycle to convert")
+          ("count",   po::value<std::size_t>(&count)->default_value(0),   "set number of clock cycles to convert, 0 for all")
+        ;
+
+        // parse arguments:
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << "\n";
+            return 0;
+        }
+        po::notify(vm);
+    }
+    catch(std::exception& e) {
+        std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << "\n";
+        return 1;
+    }
+
+    try {
+        std::FILE *output = stdout;
+        if (!output_text.empty()) {
+            output = std::fopen(output_text.c_str(), "w");
+            if (nullptr == output) {
+                throw std::runtime_error("cannot open output text file " + output_text);
+            }
+        }
+
+        std::string text;
+        if (is_packed(input_trace)) {
+            PackedTraceReader reader(input_trace);
+
+            // decode only the blocks involved, one chunk at a time:
+            const std::size_t CHUNK = PackedTrace::DEFAULT_BLOCK_RECORDS;
+            std::vector<PipelineSnapshot> records;
+            for (std::size_t cycle = from; (0 == count || cycle < from + count) && cycle < reader.size(); cycle += CHUNK) {
+                records.clear();
+                reader.read(cycle, (0 == count) ? CHUNK : std::min(CHUNK, from + count - cycle), records);
+
+                for (const auto &record: records) {
+                    PipelineTrace::render(text, record, reader);
+                    flush(text, output);
+                }
+            }
+        } else {
+            PipelineTraceReader reader(input_trace);
+
+            // records are sorted by clock cycle:
+            for (std::size_t i = reader.find(from); i < reader.size(); ++i) {
+                const PipelineSnapshot &record = reader.get(i);
+                if (0 != count && from + count <= record.cycle) {
+                    break;
+                }
+
+                PipelineTrace::render(text, record, reader);
+                flush(text, output);
+            }
+        }
+        flush(text, output, true);
+
+        if (stdout != output) {
+            std::fclose(output);
+        }
+    }
+    catch(std::runtime_error& e) {
+        std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
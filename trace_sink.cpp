@@ -0,0 +1,110 @@
+#include "trace_sink.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    /**
+        Build text segment table & text pool for binary traces.
+
+        @param text text segment.
+        @param text_table output text segment table.
+        @param text_pool output instruction source text.
+    */
+    void build_text_table(ISA::TextSegment &text, std::vector<PipelineTraceText> &text_table, std::string &text_pool) {
+        for (
+            ISA::Address address = text.get_address_first();
+            text.get_address_last() >= address;
+            address += 0x00000004
+        ) {
+            const std::string_view instruction = text.get_text(address);
+
+            text_table.push_back({address, text.get_binary(address), static_cast<std::uint32_t>(text_pool.size()), static_cast<std::uint32_t>(instruction.size())});
+            text_pool.append(instruction);
+        }
+    }
+}
+
+/**
+    Create trace sink.
+
+    @param format one of off, text, binary, packed. nullptr is returned for off.
+    @param output_filename output filename, empty for stdout (text only).
+    @param text text segment used for rendering instructions.
+*/
+std::unique_ptr<TraceSink> TraceSink::create(
+    const std::string &format, const std::string &output_filename, ISA::TextSegment &text
+) {
+    if ("off" == format) {
+        return std::unique_ptr<TraceSink>();
+    }
+
+    if ("text" != format && "binary" != format && "packed" != format) {
+        throw std::runtime_error("invalid trace format -- (off, text, binary or packed ONLY)");
+    }
+
+    std::FILE *output = stdout;
+    if (!output_filename.empty()) {
+        output = std::fopen(output_filename.c_str(), "text" == format ? "w" : "wb");
+        if (nullptr == output) {
+            throw std::runtime_error("cannot open output trace file " + output_filename);
+        }
+    } else if ("text" != format) {
+        throw std::runtime_error(format + " trace requires an output file");
+    }
+
+    if ("text" == format) {
+        return std::unique_ptr<TraceSink>(new TextTraceSink(output, text));
+    } else if ("packed" == format) {
+        return std::unique_ptr<TraceSink>(new PackedTraceSink(output, text));
+    }
+
+    return std::unique_ptr<TraceSink>(new BinaryTraceSink(output, text));
+}
+
+TextTraceSink::TextTraceSink(std::FILE *output, ISA::TextSegment &text): writer(output), text_segment(text) {
+}
+
+void TextTraceSink::record(const PipelineSnapshot &snapshot) {
+    line.clear();
+    PipelineTrace::render(line, snapshot, text_segment);
+
+    writer.write(line);
+}
+
+BinaryTraceSink::BinaryTraceSink(std::FILE *output, ISA::TextSegment &text): writer(output) {
+    // a. text segment table & text pool:
+    std::vector<PipelineTraceText> text_table;
+    std::string text_pool;
+    build_text_table(text, text_table, text_pool);
+
+    // b. header:
+    PipelineTraceHeader header;
+    std::copy(PipelineTrace::MAGIC, PipelineTrace::MAGIC + sizeof(header.magic), header.magic);
+    header.version = PipelineTrace::VERSION;
+    header.record_size = sizeof(PipelineSnapshot);
+    header.num_instructions = text_table.size();
+    header.text_pool_size = text_pool.size();
+
+    writer.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writer.write(reinterpret_cast<const char *>(text_table.data()), text_table.size() * sizeof(PipelineTraceText));
+    writer.write(text_pool);
+
+    // c. records aligned:
+    const std::size_t records_offset = PipelineTrace::get_records_offset(text_table.size(), text_pool.size());
+    const std::size_t end = sizeof(header) + text_table.size() * sizeof(PipelineTraceText) + text_pool.size();
+    writer.write(std::string(records_offset - end, '\0'));
+}
+
+void BinaryTraceSink::record(const PipelineSnapshot &snapshot) {
+    writer.write(reinterpret_cast<const char *>(&snapshot), sizeof(snapshot));
+}
+
+PackedTraceSink::PackedTraceSink(std::FILE *output, ISA::TextSegment &text) {
+    std::vector<PipelineTraceText> text_table;
+    std::string text_pool;
+    build_text_table(text, text_table, text_pool);
+
+    writer.reset(new PackedTraceWriter(output, text_table, text_pool));
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cinttypes>
+#include <memory>
+#include <string>
+
+#include "isa.h"
+#include "async_writer.h"
+#include "pipeline_trace.h"
+#include "packed_trace.h"
+
+/**
+ *  System state plot destination.
+ */
+class TraceSink {
+public:
+    virtual ~TraceSink() {}
+
+    /**
+        Record pipeline state of one clock cycle.
+
+        @param snapshot pipeline state.
+    */
+    virtual void record(const PipelineSnapshot &snapshot) = 0;
+
+    /**
+        Flush all pending records.
+    */
+    virtual void close(void) = 0;
+
+    /**
+        Create trace sink.
+
+        @param format one of off, text, binary, packed. nullptr is returned for off.
+        @param output_filename output filename, empty for stdout (text only).
+        @param text text segment used for rendering instructions.
+    */
+    static std::unique_ptr<TraceSink> create(
+        const std::string &format, const std::string &output_filename, ISA::TextSegment &text
+    );
+};
+
+/**
+ *  Human-readable system state plot.
+ */
+class TextTraceSink: public TraceSink {
+public:
+    TextTraceSink(std::FILE *output, ISA::TextSegment &text);
+
+    void record(const PipelineSnapshot &snapshot);
+    void close(void) {writer.close();}
+private:
+    AsyncWriter writer;
+    ISA::TextSegment &text_segment;
+    std::string line;
+};
+
+/**
+ *  Compact binary pipeline trace, see pipeline_trace.h.
+ */
+class BinaryTraceSink: public TraceSink {
+public:
+    BinaryTraceSink(std::FILE *output, ISA::TextSegment &text);
+
+    void record(const PipelineSnapshot &snapshot);
+    void close(void) {writer.close();}
+private:
+    AsyncWriter writer;
+};
+
+/**
+ *  Delta/varint-compressed pipeline trace with block index, see packed_trace.h.
+ */
+class PackedTraceSink: public TraceSink {
+public:
+    PackedTraceSink(std::FILE *output, ISA::TextSegment &text);
+
+    void record(const PipelineSnapshot &snapshot) {writer->write(snapshot);}
+    void close(void) {writer->close();}
+private:
+    std::unique_ptr<PackedTraceWriter> writer;
+};
@@ -0,0 +1,76 @@
+/**
+    tracepack.cpp
+    Purpose: Compress binary pipeline trace into packed pipeline trace
+
+    @version 1.0
+*/
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "pipeline_trace.h"
+#include "packed_trace.h"
+
+namespace po = boost::program_options;
+
+int main(int argc, char* argv[]) {
+    std::string input_trace, output_trace;
+    std::uint32_t block_records;
+
+    try {
+        // set parser:
+        po::options_description desc("MIPS trace compressor usage");
+        desc.add_options()
+          ("help",    "produce help message")
+          ("input",   po::value<std::string>(&input_trace)->required(),   "set input binary trace")
+          ("output",  po::value<std::string>(&output_trace)->required(),  "set output packed trace")
+          ("block",   po::value<std::uint32_t>(&block_records)->default_value(PackedTrace::DEFAULT_BLOCK_RECORDS), "set records per block")
+        ;
+
+        // parse arguments:
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << "\n";
+            return 0;
+        }
+        po::notify(vm);
+
+        if (0 == block_records) {
+            throw std::runtime_error("invalid block size -- must be positive");
+        }
+    }
+    catch(std::exception& e) {
+        std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << "\n";
+        return 1;
+    }
+
+    try {
+        PipelineTraceReader reader(input_trace);
+
+        std::FILE *output = std::fopen(output_trace.c_str(), "wb");
+        if (nullptr == output) {
+            throw std::runtime_error("cannot open output packed trace file " + output_trace);
+        }
+
+        // compress:
+        std::vector<PipelineTraceText> text_table(
+            reader.get_text_table(), reader.get_text_table() + reader.get_num_instructions()
+        );
+        PackedTraceWriter writer(output, text_table, reader.get_text_pool(), block_records);
+        for (std::size_t i = 0; i < reader.size(); ++i) {
+            writer.write(reader.get(i));
+        }
+        writer.close();
+    }
+    catch(std::runtime_error& e) {
+        std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+/**
+    tracereplay.cpp
+    Purpose: Replay recorded dynamic instruction trace through data cache & branch predictor configurations
+
+    @version 1.0
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "dynamic_trace.h"
+#include "replay.h"
+#include "sweep.h"
+
+namespace po = boost::program_options;
+
+int main(int argc, char* argv[]) {
+    std::string input_trace, sweep, output_prefix;
+    std::size_t jobs;
+
+    try {
+        // set parser:
+        po::options_description desc("MIPS trace replay usage");
+        desc.add_options()
+          ("help",    "produce help message")
+          ("input",   po::value<std::string>(&input_trace)->required(),  "set input dynamic trace")
+          ("sweep",   po::value<std::string>(&sweep)->required(),        "set configuration sweep file")
+          ("output",  po::value<std::string>(&output_prefix)->default_value("../output/replay"), "set output report filename prefix")
+          ("jobs",    po::value<std::size_t>(&jobs)->default_value(0),   "set number of replay threads, 0 for one per hardware thread")
+        ;
+
+        // parse arguments:
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << "\n";
+            return 0;
+        }
+        po::notify(vm);
+    }
+    catch(std::exception& e) {
+        std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << "\n";
+        return 1;
+    }
+
+    try {
+        DynamicTraceReader reader(input_trace);
+
+        TraceReplay replay(reader, SweepSimulator::load_configs(sweep));
+
+        replay.run(jobs);
+
+        replay.dump(output_prefix);
+    }
+    catch(std::runtime_error& e) {
+        std::cerr << "[MIPS simulator]: ERROR -- " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}